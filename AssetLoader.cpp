@@ -0,0 +1,76 @@
+// AssetLoader.cpp : background image reading and decoding.
+// Part of the GL-free simulation core.
+
+#include "AssetLoader.h"
+#include <chrono>
+
+// -------------------- Constructor / Destructor --------------------
+AssetLoader::AssetLoader(int threadCount)
+    : threadCount(threadCount < 1 ? 1 : threadCount), inFlight(0), stopping(false)
+{
+}
+
+AssetLoader::~AssetLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+// -------------------- Requests --------------------
+void AssetLoader::request(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (workers.empty()) {
+            for (int t = 0; t < threadCount; ++t)
+                workers.emplace_back(&AssetLoader::workerLoop, this);
+        }
+        queue.push_back(path);
+        ++inFlight;
+    }
+    workReady.notify_one();
+}
+
+void AssetLoader::takeFinished(std::vector<DecodedImage>& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& done : finished)
+        out.push_back(std::move(done));
+    inFlight -= static_cast<int>(finished.size());
+    finished.clear();
+}
+
+int AssetLoader::pendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return inFlight;
+}
+
+// -------------------- Worker Loop --------------------
+// Decodes outside the lock; the page walk reads one byte per 4 KB so the
+// mapping is resident before the image is handed over
+void AssetLoader::workerLoop() {
+    for (;;) {
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workReady.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            path = queue.front();
+            queue.pop_front();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<Image> image(new Image());
+        if (image->loadBMP(path)) {
+            volatile unsigned char sink = 0;
+            for (size_t i = 0; i < image->byteSize(); i += 4096) sink = sink + image->pixels[i];
+        }
+        else image.reset();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.push_back({ path, std::move(image), seconds });
+    }
+}
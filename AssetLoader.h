@@ -0,0 +1,62 @@
+#pragma once
+#include "Image.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -------------------- Decoded Asset --------------------
+// One finished request: the decoded image, or nullptr if the file is missing
+// or unsupported
+struct DecodedImage {
+    std::string path;
+    std::unique_ptr<Image> image;
+    double seconds;               // Time spent reading and decoding on the worker
+};
+
+// -------------------- AssetLoader Class --------------------
+// Reads and decodes image files on background threads, so the thread that
+// owns the GL context only has to upload finished images.
+//
+// request() queues a path and returns at once; workers (started on the first
+// request) decode queued paths in order. Images are memory-mapped, so a worker
+// also touches every page of the pixels: the upload then reads memory instead
+// of faulting the file in on the render thread. takeFinished() hands over
+// whatever is done without waiting for the rest.
+class AssetLoader {
+public:
+    // -------------------- Constructor / Destructor --------------------
+    // 'threadCount' decode threads (at least 1)
+    explicit AssetLoader(int threadCount);
+    ~AssetLoader();   // Abandons queued requests and joins the workers
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // -------------------- Requests --------------------
+    // Queues 'path' for decoding
+    void request(const std::string& path);
+
+    // Moves every finished request into 'out' (appending); never waits
+    void takeFinished(std::vector<DecodedImage>& out);
+
+    // Requests not yet taken with takeFinished()
+    int pendingCount() const;
+
+private:
+    int threadCount;
+    std::vector<std::thread> workers;     // Started by the first request()
+
+    mutable std::mutex mutex;
+    std::condition_variable workReady;    // Signals workers that 'queue' is not empty
+    std::deque<std::string> queue;        // Paths waiting for a worker
+    std::vector<DecodedImage> finished;   // Decoded, waiting for takeFinished()
+    int inFlight;                         // Requested but not yet taken
+    bool stopping;
+
+    // Worker thread main loop
+    void workerLoop();
+};
@@ -1,6 +1,9 @@
-#include "stdafx.h"
+// Car.cpp : simulation half of the Car class.
+// This translation unit is part of the GL-free simulation core, so it does not
+// include stdafx.h (which pulls in GLUT). Rendering lives in CarRenderer.cpp.
+
 #include "Car.h"
-#include <GL/glut.h>
+#include "Profiler.h"
 #include <cmath>
 #include <algorithm>
 
@@ -10,13 +13,12 @@
 #endif
 
 // -------------------- Constructor --------------------
-// Initializes a Car object with position, color, track info, and lane assignment
-Car::Car(Vector2 pos, float r, float g, float b, std::vector<Vector2>* track,
-    std::vector<std::vector<Vector2>>* lanes, int lane)
+// Initializes a Car object with position, color and lane assignment
+Car::Car(Vector2 pos, float r, float g, float b, int lane)
     : position(pos), speed(0.0f), targetSpeed(2.0f), maxSpeed(5.0f), accelerationFactor(2.0f),
-    size(0.5f), targetIndex(1), lap(0), trackPoints(track), finished(false),
-    rotation(0.0f), wheelRotation(0.0f), allLanes(lanes), laneIndex(lane), targetLaneIndex(lane),
-    laneSwitchSpeed(3.0f), rotationSpeed(5.0f), steerAngle(0.0f), slipFactor(0.1f)
+    size(0.5f), targetIndex(1), lap(0), distance(0.0f), lapProgress(0.0f), finished(false),
+    rotation(0.0f), wheelRotation(0.0f), laneIndex(lane), targetLaneIndex(lane),
+    laneSwitchSpeed(3.0f), rotationSpeed(5.0f), slipFactor(0.1f), model(CarModel::Kinematic)
 {
     // Convert RGB to 0-255 range
     colorR = r * 255;
@@ -26,140 +28,201 @@ Car::Car(Vector2 pos, float r, float g, float b, std::vector<Vector2>* track,
     laneOffset = Vector2(0, 0); // Initial lateral offset for smooth lane changes
 }
 
-// -------------------- Update Function --------------------
-// Updates the car's position, speed, rotation, lane switching, and wheel rotation each frame
-void Car::update(float dt, std::vector<Car>* cars) {
+// -------------------- Model Dispatch --------------------
+// The model is looked up once per car; everything below runs specialised for it
+void Car::update(float dt, const Track& track, std::vector<Car>* cars) {
+    switch (model) {
+    case CarModel::Grip: updateScan<GripModel>(dt, track, cars); break;
+    case CarModel::Aggressive: updateScan<AggressiveModel>(dt, track, cars); break;
+    default: updateScan<KinematicModel>(dt, track, cars); break;
+    }
+}
+
+void Car::update(float dt, const Track& track, const std::vector<Car>& cars,
+    const LaneOccupancy& occupancy, int selfIndex) {
+    switch (model) {
+    case CarModel::Grip: updateIndexed<GripModel>(dt, track, cars, occupancy, selfIndex); break;
+    case CarModel::Aggressive: updateIndexed<AggressiveModel>(dt, track, cars, occupancy, selfIndex); break;
+    default: updateIndexed<KinematicModel>(dt, track, cars, occupancy, selfIndex); break;
+    }
+}
+
+// -------------------- Update Function (full scan) --------------------
+// Updates the car's position, speed, rotation, lane switching, and wheel rotation each frame.
+// Finds neighbours by scanning every car, which makes a full tick O(N^2).
+template <class Model>
+void Car::updateScan(float dt, const Track& track, std::vector<Car>* cars) {
     if (finished) return; // Skip update if car has finished race
 
-    // Calculate vector to next target track point
-    Vector2 target = trackPoints->at(targetIndex);
-    Vector2 dir = target - position;
-    float dist = dir.length();
     float minDist = size * 2.0f; // Minimum distance to detect other cars
-
-    // -------------------- Front Car Detection --------------------
     Car* frontCar = nullptr;
-    for (auto& c : *cars) {
-        if (&c == this) continue;
-        // Check for car in the same lane ahead within minimum distance
-        if (c.laneIndex == laneIndex && c.targetIndex >= targetIndex &&
-            (c.position - position).length() < minDist * 2.0f) {
-            frontCar = &c;
-            break;
+    int newLane = -1;
+    {
+        PROFILE_SCOPE("Car::detect");
+
+        // -------------------- Front Car Detection --------------------
+        for (auto& c : *cars) {
+            if (&c == this) continue;
+            // Check for car in the same lane ahead within the model's following range
+            if (c.laneIndex == laneIndex && c.targetIndex >= targetIndex &&
+                (c.position - position).length() < minDist * Model::followRange) {
+                frontCar = &c;
+                break;
+            }
+        }
+
+        // -------------------- Lane Switching Logic --------------------
+        if (frontCar && (frontCar->position - position).length() < minDist * Model::overtakeRange) {
+            for (int attempt = 0; newLane < 0; ++attempt) {
+                int lane = Model::laneCandidate(laneIndex, track.laneCount(), attempt);
+                if (lane < 0) break;
+
+                // Ensure new lane is free of other cars
+                bool free = true;
+                for (auto& c : *cars) {
+                    if (&c != this && c.laneIndex == lane &&
+                        (c.position - position).length() < minDist * Model::laneClearance) {
+                        free = false;
+                        break;
+                    }
+                }
+                if (free) newLane = lane;
+            }
         }
     }
 
-    // -------------------- Target Speed Calculation --------------------
-    targetSpeed = maxSpeed;
-    if (frontCar) targetSpeed = std::max(0.5f, frontCar->speed - 0.5f); // Avoid collision
-
-    // -------------------- Lane Switching Logic --------------------
-    if (frontCar && (frontCar->position - position).length() < minDist * 1.5f) {
-        int newLane = -1;
-        if (laneIndex > 0) newLane = laneIndex - 1; // Check left lane
-        else if (laneIndex < allLanes->size() - 1) newLane = laneIndex + 1; // Check right lane
-
-        // Ensure new lane is free of other cars
-        if (newLane >= 0) {
-            bool spaceFree = true;
-            for (auto& c : *cars) {
-                if (&c != this && c.laneIndex == newLane &&
-                    (c.position - position).length() < minDist) {
-                    spaceFree = false;
-                    break;
+    drive(dt, track, chooseSpeed<Model>(track, frontCar), newLane);
+}
+
+// -------------------- Update Function (lane index) --------------------
+// Same behaviour as the scanning update, but neighbours come from the per-lane
+// occupancy index: the car ahead is an O(1) lookup and the target-lane gap
+// check an O(log N) search. Ordering on the progress ring also keeps the
+// front-car test correct across the lap wrap.
+template <class Model>
+void Car::updateIndexed(float dt, const Track& track, const std::vector<Car>& cars,
+    const LaneOccupancy& occupancy, int selfIndex) {
+    if (finished) return; // Skip update if car has finished race
+
+    float minDist = size * 2.0f; // Minimum distance to detect other cars
+    const Car* frontCar = nullptr;
+    int newLane = -1;
+    {
+        PROFILE_SCOPE("Car::detect");
+
+        // -------------------- Front Car Detection --------------------
+        int ahead = occupancy.ahead(selfIndex);
+        if (ahead >= 0 && (cars[ahead].position - position).length() < minDist * Model::followRange)
+            frontCar = &cars[ahead];
+
+        // -------------------- Lane Switching Logic --------------------
+        if (frontCar && (frontCar->position - position).length() < minDist * Model::overtakeRange) {
+            for (int attempt = 0; newLane < 0; ++attempt) {
+                int lane = Model::laneCandidate(laneIndex, track.laneCount(), attempt);
+                if (lane < 0) break;
+
+                // Only the nearest cars behind and ahead on the new lane can block it
+                int behindCar, aheadCar;
+                occupancy.neighbours(lane, progressKey(), selfIndex, behindCar, aheadCar);
+                bool free = true;
+                for (int other : { behindCar, aheadCar }) {
+                    if (other >= 0 && (cars[other].position - position).length() < minDist * Model::laneClearance)
+                        free = false;
                 }
+                if (free) newLane = lane;
             }
-            if (spaceFree) targetLaneIndex = newLane; // Set new lane target
         }
     }
 
+    drive(dt, track, chooseSpeed<Model>(track, frontCar), newLane);
+}
+
+// -------------------- Target Speed --------------------
+// Follow the car ahead, else drive flat out; grip-limited models also cap the
+// speed by the curvature of the segment the car is on
+template <class Model>
+float Car::chooseSpeed(const Track& track, const Car* frontCar) const {
+    float target = frontCar ? Model::followSpeed(frontCar->speed) : maxSpeed; // Avoid collision
+    if (Model::cornering) {
+        int n = track.pointCount();
+        int segment = (targetIndex + n - 1) % n;
+        target = std::min(target, Model::speedLimit(maxSpeed, track.curvatureAt(laneIndex, segment), slipFactor));
+    }
+    return target;
+}
+
+// -------------------- Placement --------------------
+// Places the car exactly on a lane point; used when building the starting grid
+void Car::placeOnLane(const Track& track, int lane, int pointIndex) {
+    int n = track.pointCount();
+    laneIndex = targetLaneIndex = lane;
+    distance = track.arcAt(lane, pointIndex);
+    lapProgress = distance / track.laneLength(lane);
+    position = track.lanePoints(lane)[pointIndex];
+    laneOffset = Vector2(0, 0);
+    targetIndex = (pointIndex + 1) % n;
+}
+
+// -------------------- Drive --------------------
+// Applies the traffic decision (target speed, free lane to switch to) and moves the
+// car along its lane by arc length. Position and heading come from the track's
+// precomputed tables, so no square roots or trig are needed per tick.
+void Car::drive(float dt, const Track& track, float newTargetSpeed, int newLane) {
+    targetSpeed = newTargetSpeed;
+
+    // -------------------- Lane Switch --------------------
+    // Move onto the new lane at the same lap fraction; the offset keeps the car
+    // where it is and then glides it onto the new lane's centre line
+    if (newLane >= 0 && newLane != laneIndex) {
+        Vector2 from = position;
+        laneIndex = targetLaneIndex = newLane;
+        distance = lapProgress * track.laneLength(laneIndex);
+        laneOffset = from - track.pointAt(laneIndex, distance, track.segmentAt(laneIndex, distance));
+    }
+
     // -------------------- Smooth Acceleration --------------------
     speed += (targetSpeed - speed) * dt * accelerationFactor;
     if (speed < 0) speed = 0;
 
     // -------------------- Smooth Lane Offset --------------------
-    Vector2 desiredOffset = Vector2(0, (targetLaneIndex - laneIndex) * 1.5f);
-    laneOffset += (desiredOffset - laneOffset) * dt * laneSwitchSpeed;
+    laneOffset += (Vector2(0, 0) - laneOffset) * dt * laneSwitchSpeed;
+
+    // -------------------- Advance Along Lane --------------------
+    float laneLength = track.laneLength(laneIndex);
+    distance += speed * dt;
+    while (distance >= laneLength) {
+        distance -= laneLength;
+        lap++; // Crossed the start/finish line
+    }
+    lapProgress = distance / laneLength;
 
-    // -------------------- Steering & Rotation --------------------
-    if (dist > 0.01f) {
-        Vector2 moveDir = dir.normalized();
-        float desiredRotation = atan2(moveDir.y, moveDir.x) * 180.0f / M_PI;
-        float rotationDiff = desiredRotation - rotation;
+    int segment = track.segmentAt(laneIndex, distance);
+    int pointCount = track.pointCount();
+    targetIndex = (segment + 1) % pointCount;
+    position = track.pointAt(laneIndex, distance, segment) + laneOffset;
 
-        // Keep rotation difference between -180 to 180
-        if (rotationDiff > 180) rotationDiff -= 360;
-        if (rotationDiff < -180) rotationDiff += 360;
+    // -------------------- Steering & Rotation --------------------
+    float rotationDiff = track.headingAt(laneIndex, segment) - rotation;
 
-        rotation += rotationDiff * dt * rotationSpeed; // Smoothly rotate car
-    }
+    // Keep rotation difference between -180 to 180
+    if (rotationDiff > 180) rotationDiff -= 360;
+    if (rotationDiff < -180) rotationDiff += 360;
 
-    // -------------------- Position Update --------------------
-    if (dist > 0.01f)
-        position += dir.normalized() * speed * dt + laneOffset * dt;
+    rotation += rotationDiff * dt * rotationSpeed; // Smoothly rotate car
 
     // -------------------- Wheel Rotation --------------------
     wheelRotation += speed * dt * 360.0f / (2.0f * M_PI * size); // Rotate wheels based on speed
-
-    // -------------------- Track Progress --------------------
-    if (dist < 0.1f) {
-        targetIndex++;
-        if (targetIndex >= trackPoints->size()) {
-            lap++;          // Increment lap
-            targetIndex = 0; // Loop track
-        }
-    }
-
-    // Update lane index after possible lane change
-    laneIndex = targetLaneIndex;
 }
 
-// -------------------- Draw Function --------------------
-// Draws the car as a colored rectangle with simple wheels, applying rotation and lane offset
-void Car::draw() {
-    if (finished) return; // Skip drawing finished cars
-
-    glPushMatrix();
-    glTranslatef(position.x, position.y, 0.0f); // Move to car position
-    glRotatef(rotation, 0.0f, 0.0f, 1.0f);      // Rotate car according to movement direction
-
-    // -------------------- Draw Car Body --------------------
-    glColor3ub(colorR, colorG, colorB); // Set car color
-    glBegin(GL_QUADS);
-    glVertex2f(-size, -size);
-    glVertex2f(size, -size);
-    glVertex2f(size, size);
-    glVertex2f(-size, size);
-    glEnd();
-
-    // -------------------- Draw Wheels --------------------
-    float wheelSize = size / 3.0f;
-
-    // Left wheel
-    glPushMatrix();
-    glTranslatef(-size + wheelSize, -size, 0);
-    glRotatef(wheelRotation, 0, 0, 1);
-    glColor3ub(0, 0, 0); // Black wheels
-    glBegin(GL_QUADS);
-    glVertex2f(-wheelSize, -wheelSize);
-    glVertex2f(wheelSize, -wheelSize);
-    glVertex2f(wheelSize, wheelSize);
-    glVertex2f(-wheelSize, wheelSize);
-    glEnd();
-    glPopMatrix();
-
-    // Right wheel
-    glPushMatrix();
-    glTranslatef(size - wheelSize, -size, 0);
-    glRotatef(wheelRotation, 0, 0, 1);
-    glColor3ub(0, 0, 0);
-    glBegin(GL_QUADS);
-    glVertex2f(-wheelSize, -wheelSize);
-    glVertex2f(wheelSize, -wheelSize);
-    glVertex2f(wheelSize, wheelSize);
-    glVertex2f(-wheelSize, wheelSize);
-    glEnd();
-    glPopMatrix();
-
-    glPopMatrix(); // Restore transform
+// -------------------- Pose Interpolation --------------------
+CarPose interpolatePose(const CarPose& from, const CarPose& to, float alpha) {
+    float rotationDiff = to.rotation - from.rotation;
+    if (rotationDiff > 180) rotationDiff -= 360;
+    if (rotationDiff < -180) rotationDiff += 360;
+
+    CarPose pose;
+    pose.position = from.position + (to.position - from.position) * alpha;
+    pose.rotation = from.rotation + rotationDiff * alpha;
+    pose.wheelRotation = from.wheelRotation + (to.wheelRotation - from.wheelRotation) * alpha;
+    return pose;
 }
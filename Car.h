@@ -1,10 +1,26 @@
 #pragma once
 #include "Vector2.h"
+#include "CarModel.h"
+#include "LaneOccupancy.h"
+#include "Track.h"
 #include <vector>
 
+// -------------------- Render Pose --------------------
+// The part of a car's state needed to draw it. The renderer blends the poses
+// of the last two simulation ticks, so drawing is independent of the tick rate.
+struct CarPose {
+    Vector2 position;        // Car position
+    float rotation;          // Orientation in degrees
+    float wheelRotation;     // Wheel animation angle
+};
+
+// Pose 'alpha' of the way from 'from' to 'to' (rotation along the shorter arc)
+CarPose interpolatePose(const CarPose& from, const CarPose& to, float alpha);
+
 // -------------------- Car Class --------------------
 // Represents a single car in the racing simulation.
-// Handles movement, lane switching, acceleration, rotation, and rendering.
+// Handles movement, lane switching, acceleration and rotation.
+// Rendering is done by drawCar() in CarRenderer.h so this class stays GL-free.
 class Car {
 public:
     // -------------------- Position & Movement --------------------
@@ -25,30 +41,62 @@ public:
     // -------------------- Track Progress --------------------
     int targetIndex;           // Index of the next track point to reach
     int lap;                   // Current lap number
-    std::vector<Vector2>* trackPoints; // Pointer to the vector of track points
+    float distance;            // Arc length travelled along the current lane this lap
+    float lapProgress;         // Fraction of the lap completed, in [0, 1)
     bool finished;             // Flag indicating if the car has finished the race
 
     // -------------------- Lane Management --------------------
-    std::vector<std::vector<Vector2>>* allLanes; // Pointer to all lanes on track
+    // Lanes are referred to by index (see Track::lanePoints), so a Car holds no
+    // pointers and can be copied as plain bytes (see Simulation::snapshot)
     int laneIndex;            // Current lane index the car occupies
-    Vector2 laneOffset;       // Lateral offset for smooth lane switching
+    Vector2 laneOffset;       // Offset from the lane centre line, decays to zero after a lane switch
     int targetLaneIndex;      // Lane index the car is trying to switch to
 
     // -------------------- Steering & Control --------------------
     float laneSwitchSpeed;    // Speed factor for lateral lane movement
     float rotationSpeed;      // Speed factor for smooth rotation adjustment
-    float steerAngle;         // Current steering angle for visual or physics purposes
-    float slipFactor;         // Factor for simulating car slipping during turns
+    float slipFactor;         // Fraction of cornering grip lost to slip (Grip model)
+
+    // -------------------- Behaviour --------------------
+    CarModel model;           // Driving rules (see CarModel.h), Kinematic by default
 
     // -------------------- Constructor --------------------
-    // Initializes a car with position, color, track information, and initial lane
-    Car(Vector2 pos, float r, float g, float b, std::vector<Vector2>* track,
-        std::vector<std::vector<Vector2>>* lanes, int lane);
+    // Initializes a car with position, color and initial lane
+    Car(Vector2 pos, float r, float g, float b, int lane);
+
+    // -------------------- Placement --------------------
+    // Puts the car on point 'pointIndex' of 'lane' with no lateral offset
+    void placeOnLane(const Track& track, int lane, int pointIndex);
 
     // -------------------- Simulation Functions --------------------
     // Updates the car's speed, position, rotation, lane switching, and lap progress
-    void update(float dt, std::vector<Car>* cars);
+    // following the rules of its model.
+    // Finds neighbours by scanning all cars (O(N) per car).
+    void update(float dt, const Track& track, std::vector<Car>* cars);
+
+    // Same update, with neighbours looked up in a per-lane occupancy index built
+    // from progressKey(); 'selfIndex' is this car's index in 'cars'
+    void update(float dt, const Track& track, const std::vector<Car>& cars,
+        const LaneOccupancy& occupancy, int selfIndex);
+
+    // Occupancy key: fraction of the lap completed, comparable between lanes
+    float progressKey() const { return lapProgress; }
+
+    // Continuous race progress in laps (lap number plus lap fraction), for ranking
+    float raceProgress() const { return lap + lapProgress; }
+
+    // Current render pose
+    CarPose pose() const { return { position, rotation, wheelRotation }; }
+
+private:
+    // The two updates specialised for one model's rules (defined in Car.cpp)
+    template <class Model> void updateScan(float dt, const Track& track, std::vector<Car>* cars);
+    template <class Model> void updateIndexed(float dt, const Track& track, const std::vector<Car>& cars,
+        const LaneOccupancy& occupancy, int selfIndex);
+
+    // Target speed from the car ahead (if any) and the model's corner limit
+    template <class Model> float chooseSpeed(const Track& track, const Car* frontCar) const;
 
-    // Renders the car body and wheels at the current position and rotation
-    void draw();
+    // Applies the traffic decision and advances the car along its lane for one step
+    void drive(float dt, const Track& track, float newTargetSpeed, int newLane);
 };
@@ -0,0 +1,171 @@
+// CarCollisions.cpp : sweep-and-prune car collision detection and resolution.
+// Part of the GL-free simulation core.
+
+#include "CarCollisions.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// -------------------- Constructor --------------------
+CarCollisions::CarCollisions()
+    : restitution(0.2f), axis(0), bandHeight(0.0f), candidates(0)
+{
+}
+
+// -------------------- Narrowphase --------------------
+// Separating axis test of two squares (centre, unit heading, half-size).
+// Keeps the axis of least overlap; false if any axis separates them.
+static bool overlapSquares(float ax, float ay, float ahx, float ahy, float as,
+    float bx, float by, float bhx, float bhy, float bs, CarContact& contact) {
+    const float axes[4][2] = { { ahx, ahy }, { -ahy, ahx }, { bhx, bhy }, { -bhy, bhx } };
+    float dx = bx - ax, dy = by - ay;
+    float best = 1e30f;
+    for (int k = 0; k < 4; ++k) {
+        float ux = axes[k][0], uy = axes[k][1];
+        // A square's radius on its own axes is its half-size
+        float ra = k < 2 ? as : as * (std::fabs(ux * ahx + uy * ahy) + std::fabs(uy * ahx - ux * ahy));
+        float rb = k >= 2 ? bs : bs * (std::fabs(ux * bhx + uy * bhy) + std::fabs(uy * bhx - ux * bhy));
+        float distance = ux * dx + uy * dy;
+        float overlap = ra + rb - std::fabs(distance);
+        if (overlap <= 0.0f) return false;
+        if (overlap < best) {
+            best = overlap;
+            float sign = distance < 0.0f ? -1.0f : 1.0f;
+            contact.normalX = ux * sign;
+            contact.normalY = uy * sign;
+        }
+    }
+    contact.depth = best;
+    return true;
+}
+
+// -------------------- Detection --------------------
+void CarCollisions::detect(int count, const float* x, const float* y, const float* rotation, const float* size) {
+    PROFILE_SCOPE("collisions::detect");
+    found.clear();
+    candidates = 0;
+    lower.resize(count);
+    upper.resize(count);
+    crossLower.resize(count);
+    crossUpper.resize(count);
+    headingX.resize(count);
+    headingY.resize(count);
+    band.resize(count);
+
+    // Sweep along the axis the cars spread further along
+    float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f, maxSize = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        minX = std::min(minX, x[i]);
+        maxX = std::max(maxX, x[i]);
+        minY = std::min(minY, y[i]);
+        maxY = std::max(maxY, y[i]);
+        maxSize = std::max(maxSize, size[i]);
+    }
+    int newAxis = maxY - minY > maxX - minX ? 1 : 0;
+    const float* sweep = newAxis ? y : x;
+    const float* cross = newAxis ? x : y;
+
+    // Bands at least as tall as two of the largest boxes: overlapping cars
+    // lie in the same or in neighbouring bands
+    float newBandHeight = std::max(2.0f * 1.4143f * maxSize, 1e-3f);
+    float bandScale = 1.0f / newBandHeight;
+
+    // Bounding boxes of the rotated squares
+    for (int i = 0; i < count; ++i) {
+        float radians = rotation[i] * static_cast<float>(M_PI / 180.0);
+        headingX[i] = std::cos(radians);
+        headingY[i] = std::sin(radians);
+        float extent = size[i] * (std::fabs(headingX[i]) + std::fabs(headingY[i]));
+        lower[i] = sweep[i] - extent;
+        upper[i] = sweep[i] + extent;
+        crossLower[i] = cross[i] - extent;
+        crossUpper[i] = cross[i] + extent;
+        band[i] = static_cast<int>(std::floor(cross[i] * bandScale));
+    }
+
+    // Repair the previous order; a new field, axis or band height is sorted
+    // from scratch. Ties go by car index, so the order (and with it the order
+    // of the contacts) depends only on the current positions, not on history.
+    auto before = [this](int a, int b) {
+        if (band[a] != band[b]) return band[a] < band[b];
+        return lower[a] != lower[b] ? lower[a] < lower[b] : a < b;
+    };
+    if (static_cast<int>(order.size()) != count || newAxis != axis || newBandHeight != bandHeight) {
+        order.resize(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), before);
+        axis = newAxis;
+        bandHeight = newBandHeight;
+    }
+    else {
+        for (int i = 1; i < count; ++i) {
+            int car = order[i];
+            int j = i - 1;
+            for (; j >= 0 && before(car, order[j]); --j) order[j + 1] = order[j];
+            order[j + 1] = car;
+        }
+    }
+
+    // Sweep every band against itself and against the next band
+    auto test = [&](int a, int b) {
+        if (crossLower[b] > crossUpper[a] || crossLower[a] > crossUpper[b]) return;
+        ++candidates;
+        int first = std::min(a, b), second = std::max(a, b);
+        CarContact contact;
+        if (overlapSquares(x[first], y[first], headingX[first], headingY[first], size[first],
+                x[second], y[second], headingX[second], headingY[second], size[second], contact)) {
+            contact.a = first;
+            contact.b = second;
+            found.push_back(contact);
+        }
+    };
+    float maxExtent = 1.4143f * maxSize;
+    for (int begin = 0, end = 0; begin < count; begin = end) {
+        int current = band[order[begin]];
+        for (end = begin + 1; end < count && band[order[end]] == current; ++end) {}
+        int nextEnd = end;
+        if (end < count && band[order[end]] == current + 1)
+            for (; nextEnd < count && band[order[nextEnd]] == current + 1; ++nextEnd) {}
+
+        int next = end; // First car of the next band that may still reach the current car
+        for (int i = begin; i < end; ++i) {
+            int a = order[i];
+            for (int j = i + 1; j < end && lower[order[j]] <= upper[a]; ++j)
+                test(a, order[j]);
+            while (next < nextEnd && lower[order[next]] < lower[a] - 2.0f * maxExtent) ++next;
+            for (int j = next; j < nextEnd && lower[order[j]] <= upper[a]; ++j)
+                if (upper[order[j]] >= lower[a]) test(a, order[j]);
+        }
+    }
+}
+
+// -------------------- Resolution --------------------
+void CarCollisions::resolve(float* x, float* y, float* offsetX, float* offsetY, float* speed) const {
+    for (const CarContact& contact : found) {
+        int a = contact.a, b = contact.b;
+        float nx = contact.normalX, ny = contact.normalY;
+
+        // Separate: half the depth each, along the normal
+        float push = contact.depth * 0.5f;
+        x[a] -= nx * push; y[a] -= ny * push;
+        x[b] += nx * push; y[b] += ny * push;
+        offsetX[a] -= nx * push; offsetY[a] -= ny * push;
+        offsetX[b] += nx * push; offsetY[b] += ny * push;
+
+        // Exchange the closing part of the velocities (equal masses)
+        float vax = headingX[a] * speed[a], vay = headingY[a] * speed[a];
+        float vbx = headingX[b] * speed[b], vby = headingY[b] * speed[b];
+        float closing = (vbx - vax) * nx + (vby - vay) * ny;
+        if (closing >= 0.0f) continue; // Already moving apart
+        float impulse = -closing * 0.5f * (1.0f + restitution);
+        vax -= nx * impulse; vay -= ny * impulse;
+        vbx += nx * impulse; vby += ny * impulse;
+        speed[a] = std::max(0.0f, vax * headingX[a] + vay * headingY[a]);
+        speed[b] = std::max(0.0f, vbx * headingX[b] + vby * headingY[b]);
+    }
+}
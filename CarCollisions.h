@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+
+// -------------------- Contact --------------------
+// Two overlapping cars: a < b, the normal points from a to b and 'depth' is
+// how far they must move apart along it
+struct CarContact {
+    int a, b;
+    float normalX, normalY;
+    float depth;
+};
+
+// -------------------- CarCollisions Class --------------------
+// Finds and resolves overlapping car bodies. A car's body is the square drawn
+// by the renderer: half-size 'size', turned by 'rotation' degrees.
+//
+// Broadphase: sweep and prune in bands. Each car's bounding box is projected
+// onto the sweep axis (x or y, whichever the cars spread further along); the
+// other axis is cut into bands two boxes wide, so overlapping cars sit in the
+// same or in neighbouring bands. Cars are kept sorted by band, then by the
+// lower end of their interval. The order persists between detect() calls and
+// is repaired with an insertion sort: cars move little per tick, so that is
+// close to one linear pass. Each band is then swept against itself and the
+// next band, pairing only cars whose intervals overlap. A single sweep over
+// the whole field would pair every car with all cars level with it along the
+// track's straights; the bands keep the pass near O(N) even for dense fields.
+//
+// Narrowphase: separating axis test of the two rotated squares (two axes
+// each), which also gives the push-out normal and depth.
+//
+// Resolution: one pass over the contacts in sweep order. Each pair is moved
+// apart by half the depth each, and the part of their velocities that closes
+// the gap is exchanged like an impulse between equal masses. Cars keep only
+// scalar speeds, so the new velocity is projected back onto the heading.
+class CarCollisions {
+public:
+    float restitution;     // Fraction of the closing speed returned as separation (0 = none)
+
+    // -------------------- Constructor --------------------
+    CarCollisions();
+
+    // -------------------- Detection --------------------
+    // Finds the overlapping pairs among 'count' cars
+    void detect(int count, const float* x, const float* y, const float* rotation, const float* size);
+
+    // Overlapping pairs of the last detect(), in sweep order (a function of
+    // the positions alone, so resolution is deterministic)
+    const std::vector<CarContact>& contacts() const { return found; }
+
+    // -------------------- Resolution --------------------
+    // Pushes every contact pair apart (moving both 'x'/'y' and the lane
+    // offsets, so the displacement persists and then eases out) and removes
+    // their closing speed. Uses the headings of the last detect().
+    void resolve(float* x, float* y, float* offsetX, float* offsetY, float* speed) const;
+
+    // -------------------- Statistics --------------------
+    int candidatePairs() const { return candidates; }  // Broadphase pairs of the last detect()
+
+private:
+    int axis;                       // Sweep axis: 0 = x, 1 = y
+    float bandHeight;               // Width of the bands across the sweep axis
+    int candidates;
+    std::vector<int> order;         // Cars sorted by band, then 'lower' (kept between calls)
+    std::vector<int> band;          // Band of every car on the other axis
+    std::vector<float> lower, upper;       // Bounding box on the sweep axis
+    std::vector<float> crossLower, crossUpper; // Bounding box on the other axis
+    std::vector<float> headingX, headingY;     // Unit heading of every car
+    std::vector<CarContact> found;
+};
@@ -0,0 +1,319 @@
+// CarFleet.cpp : structure-of-arrays car storage and batched update kernel.
+// Part of the GL-free simulation core.
+
+#include "CarFleet.h"
+#include "Profiler.h"
+#include <cmath>
+#include <algorithm>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// -------------------- Constructor --------------------
+CarFleet::CarFleet(const Track* track)
+    : collisions(false), track(track)
+{
+}
+
+// -------------------- Add Car --------------------
+// Splits an AoS car into the hot and cold arrays
+void CarFleet::addCar(const Car& car) {
+    hot.posX.push_back(car.position.x);
+    hot.posY.push_back(car.position.y);
+    hot.speed.push_back(car.speed);
+    hot.targetSpeed.push_back(car.targetSpeed);
+    hot.maxSpeed.push_back(car.maxSpeed);
+    hot.accelerationFactor.push_back(car.accelerationFactor);
+    hot.rotation.push_back(car.rotation);
+    hot.offsetX.push_back(car.laneOffset.x);
+    hot.offsetY.push_back(car.laneOffset.y);
+    hot.laneSwitchSpeed.push_back(car.laneSwitchSpeed);
+    hot.rotationSpeed.push_back(car.rotationSpeed);
+    hot.slipFactor.push_back(car.slipFactor);
+    hot.size.push_back(car.size);
+    hot.distance.push_back(car.distance);
+    hot.lapProgress.push_back(car.lapProgress);
+    hot.targetIndex.push_back(car.targetIndex);
+    hot.lap.push_back(car.lap);
+    hot.laneIndex.push_back(car.laneIndex);
+    hot.targetLaneIndex.push_back(car.targetLaneIndex);
+    hot.finished.push_back(car.finished ? 1 : 0);
+
+    cold.colorR.push_back(static_cast<std::uint8_t>(car.colorR));
+    cold.colorG.push_back(static_cast<std::uint8_t>(car.colorG));
+    cold.colorB.push_back(static_cast<std::uint8_t>(car.colorB));
+    cold.wheelRotation.push_back(car.wheelRotation);
+
+    buckets[static_cast<int>(car.model)].push_back(count() - 1);
+}
+
+// -------------------- Assign --------------------
+void CarFleet::assign(const std::vector<Car>& cars) {
+    hot = HotState();
+    cold = ColdState();
+    for (auto& bucket : buckets) bucket.clear();
+    for (const auto& car : cars)
+        addCar(car);
+}
+
+// -------------------- Store Back --------------------
+// Copies the simulated state back into AoS cars (e.g. for rendering)
+void CarFleet::storeTo(std::vector<Car>& cars) const {
+    int n = std::min(count(), static_cast<int>(cars.size()));
+    for (int i = 0; i < n; ++i) {
+        Car& car = cars[i];
+        car.position = Vector2(hot.posX[i], hot.posY[i]);
+        car.speed = hot.speed[i];
+        car.targetSpeed = hot.targetSpeed[i];
+        car.rotation = hot.rotation[i];
+        car.laneOffset = Vector2(hot.offsetX[i], hot.offsetY[i]);
+        car.distance = hot.distance[i];
+        car.lapProgress = hot.lapProgress[i];
+        car.targetIndex = hot.targetIndex[i];
+        car.lap = hot.lap[i];
+        car.laneIndex = hot.laneIndex[i];
+        car.targetLaneIndex = hot.targetLaneIndex[i];
+        car.finished = hot.finished[i] != 0;
+        car.wheelRotation = cold.wheelRotation[i];
+    }
+}
+
+// -------------------- Simulation Step --------------------
+// Every per-car pass writes only the car's own slots, so with a pool each pass
+// is split into contiguous ranges; only the occupancy refresh runs serially.
+void CarFleet::step(float dt, ThreadPool* pool) {
+    PROFILE_SCOPE("CarFleet::step");
+    int n = count();
+    baseX.resize(n);
+    baseY.resize(n);
+    rotationError.resize(n);
+    active.resize(n);
+
+    auto run = [pool, n](const std::function<void(int, int)>& pass) {
+        if (pool) pool->parallelFor(n, pass);
+        else pass(0, n);
+    };
+
+    occupancy.update(track->laneCount(), n, hot.laneIndex.data(), hot.lapProgress.data());
+    decideBucket<KinematicModel>(pool);
+    decideBucket<GripModel>(pool);
+    decideBucket<AggressiveModel>(pool);
+    run([this, dt](int begin, int end) {
+        commitLaneSwitches(begin, end);
+        integrate(dt, begin, end);
+        placeOnTrack(begin, end);
+        finish(dt, begin, end);
+    });
+
+    // -------------------- Phase 5: Collisions --------------------
+    // The field arrays are the collider's input and output as they are
+    if (collisions) {
+        PROFILE_SCOPE("collisions");
+        collider.detect(n, hot.posX.data(), hot.posY.data(), hot.rotation.data(), hot.size.data());
+        collider.resolve(hot.posX.data(), hot.posY.data(), hot.offsetX.data(), hot.offsetY.data(), hot.speed.data());
+    }
+}
+
+// -------------------- Phase 1: Traffic Decision --------------------
+// Same rules as Car::update: slow down behind a close car in the same lane and
+// try the lanes the model allows when they are free. Neighbours come from the
+// per-lane occupancy index, refreshed once per step. Reads other cars'
+// positions/speeds/lanes, writes only the car's own slots (targetSpeed,
+// targetLaneIndex, active), so buckets and ranges can run in any order.
+template <class Model>
+void CarFleet::decideTraffic(const int* ids, int begin, int end) {
+    PROFILE_SCOPE("CarFleet::detect");
+    int laneCount = track->laneCount();
+    int pointCount = track->pointCount();
+
+    for (int k = begin; k < end; ++k) {
+        int i = ids[k];
+        active[i] = hot.finished[i] ? 0.0f : 1.0f;
+        if (hot.finished[i]) continue;
+
+        // -------------------- Front Car Detection --------------------
+        float minDist = hot.size[i] * 2.0f;
+        int front = occupancy.ahead(i);
+        float frontDistSq = 0.0f;
+        if (front >= 0) {
+            float ox = hot.posX[front] - hot.posX[i];
+            float oy = hot.posY[front] - hot.posY[i];
+            frontDistSq = ox * ox + oy * oy;
+            float range = minDist * Model::followRange;
+            if (frontDistSq >= range * range) front = -1;
+        }
+
+        // -------------------- Target Speed --------------------
+        float target = front >= 0 ? Model::followSpeed(hot.speed[front]) : hot.maxSpeed[i];
+        if (Model::cornering) {
+            int segment = (hot.targetIndex[i] + pointCount - 1) % pointCount;
+            float curvature = track->curvatureAt(hot.laneIndex[i], segment);
+            target = std::min(target, Model::speedLimit(hot.maxSpeed[i], curvature, hot.slipFactor[i]));
+        }
+        hot.targetSpeed[i] = target;
+
+        // -------------------- Lane Switching --------------------
+        float overtake = minDist * Model::overtakeRange;
+        if (front >= 0 && frontDistSq < overtake * overtake) {
+            float clearance = minDist * Model::laneClearance;
+            for (int attempt = 0; ; ++attempt) {
+                int newLane = Model::laneCandidate(hot.laneIndex[i], laneCount, attempt);
+                if (newLane < 0) break;
+
+                // Only the nearest cars behind and ahead on the new lane can block it
+                int behindCar, aheadCar;
+                occupancy.neighbours(newLane, hot.lapProgress[i], i, behindCar, aheadCar);
+                bool spaceFree = true;
+                for (int j : { behindCar, aheadCar }) {
+                    if (j < 0) continue;
+                    float ox = hot.posX[j] - hot.posX[i];
+                    float oy = hot.posY[j] - hot.posY[i];
+                    if (ox * ox + oy * oy < clearance * clearance) spaceFree = false;
+                }
+                if (spaceFree) {
+                    hot.targetLaneIndex[i] = newLane;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+template <class Model>
+void CarFleet::decideBucket(ThreadPool* pool) {
+    const std::vector<int>& ids = buckets[static_cast<int>(Model::id)];
+    if (ids.empty()) return;
+    auto pass = [this, &ids](int begin, int end) { decideTraffic<Model>(ids.data(), begin, end); };
+    if (pool) pool->parallelFor(static_cast<int>(ids.size()), pass);
+    else pass(0, static_cast<int>(ids.size()));
+}
+
+// -------------------- Lane Switch Commit --------------------
+// Same as Car::drive: keep the lap fraction on the new lane and turn the jump
+// between centre lines into an offset that integrate() lerps back to zero
+void CarFleet::commitLaneSwitches(int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+        int lane = hot.targetLaneIndex[i];
+        if (hot.finished[i] || lane == hot.laneIndex[i]) continue;
+
+        float s = hot.lapProgress[i] * track->laneLength(lane);
+        Vector2 onLane = track->pointAt(lane, s, track->segmentAt(lane, s));
+        hot.laneIndex[i] = lane;
+        hot.distance[i] = s;
+        hot.offsetX[i] = hot.posX[i] - onLane.x;
+        hot.offsetY[i] = hot.posY[i] - onLane.y;
+    }
+}
+
+// -------------------- Integration Kernels --------------------
+// Plain loops over restrict-qualified array parameters with no calls, branches
+// or float compares, so each one compiles to SIMD code. Finished cars are
+// masked out arithmetically with the 0/1 'active' weights set in decideTraffic().
+
+// Smooth acceleration toward the target speed
+static void accelerateKernel(int n, float dt, float* __restrict speed,
+    const float* __restrict targetSpeed, const float* __restrict accel, const float* __restrict active) {
+    for (int i = 0; i < n; ++i) {
+        float s = speed[i] + (targetSpeed[i] - speed[i]) * dt * accel[i];
+        s = std::max(s, 0.0f);
+        speed[i] += (s - speed[i]) * active[i];
+    }
+}
+
+// Lane offset lerp back to the lane centre line
+static void laneOffsetKernel(int n, float dt, float* __restrict offX, float* __restrict offY,
+    const float* __restrict laneSwitch, const float* __restrict active) {
+    for (int i = 0; i < n; ++i) {
+        float k = dt * laneSwitch[i] * active[i];
+        offX[i] -= offX[i] * k;
+        offY[i] -= offY[i] * k;
+    }
+}
+
+// Arc-length advance along the lane
+static void advanceKernel(int n, float dt, float* __restrict distance,
+    const float* __restrict speed, const float* __restrict active) {
+    for (int i = 0; i < n; ++i)
+        distance[i] += speed[i] * dt * active[i];
+}
+
+// Rotation smoothing by the pre-wrapped heading error
+static void rotationKernel(int n, float dt, float* __restrict rotation,
+    const float* __restrict rotError, const float* __restrict rotSpeed) {
+    for (int i = 0; i < n; ++i)
+        rotation[i] += rotError[i] * dt * rotSpeed[i];
+}
+
+// Final position: centre-line point plus lane offset (finished cars stay put)
+static void positionKernel(int n, float* __restrict posX, float* __restrict posY,
+    const float* __restrict baseX, const float* __restrict baseY,
+    const float* __restrict offX, const float* __restrict offY, const float* __restrict active) {
+    for (int i = 0; i < n; ++i) {
+        posX[i] += (baseX[i] + offX[i] - posX[i]) * active[i];
+        posY[i] += (baseY[i] + offY[i] - posY[i]) * active[i];
+    }
+}
+
+// Wheel animation (cold data, visual only)
+static void wheelKernel(int n, float dt, float* __restrict wheel,
+    const float* __restrict speed, const float* __restrict size, const float* __restrict active) {
+    const float wheelFactor = 360.0f / (2.0f * static_cast<float>(M_PI));
+    for (int i = 0; i < n; ++i)
+        wheel[i] += speed[i] * dt * wheelFactor / size[i] * active[i];
+}
+
+// -------------------- Phase 2: Integrate --------------------
+// Runs the kernels over [begin, end) in the same order as the scalar Car::drive
+void CarFleet::integrate(float dt, int begin, int end) {
+    const int n = end - begin;
+    const int b = begin;
+    accelerateKernel(n, dt, hot.speed.data() + b, hot.targetSpeed.data() + b,
+        hot.accelerationFactor.data() + b, active.data() + b);
+    laneOffsetKernel(n, dt, hot.offsetX.data() + b, hot.offsetY.data() + b,
+        hot.laneSwitchSpeed.data() + b, active.data() + b);
+    advanceKernel(n, dt, hot.distance.data() + b, hot.speed.data() + b, active.data() + b);
+}
+
+// -------------------- Phase 3: Track Placement --------------------
+// Lap wrap, then O(1) table lookups for the centre-line point and heading error
+void CarFleet::placeOnTrack(int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+        rotationError[i] = 0.0f;
+        if (hot.finished[i]) continue;
+
+        int lane = hot.laneIndex[i];
+        float laneLength = track->laneLength(lane);
+        while (hot.distance[i] >= laneLength) {
+            hot.distance[i] -= laneLength;
+            hot.lap[i]++; // Crossed the start/finish line
+        }
+        float s = hot.distance[i];
+        hot.lapProgress[i] = s / laneLength;
+
+        int segment = track->segmentAt(lane, s);
+        int pointCount = track->pointCount();
+        hot.targetIndex[i] = (segment + 1) % pointCount;
+
+        Vector2 base = track->pointAt(lane, s, segment);
+        baseX[i] = base.x;
+        baseY[i] = base.y;
+
+        // Heading error, wrapped to -180..180 degrees
+        float rotationDiff = track->headingAt(lane, segment) - hot.rotation[i];
+        if (rotationDiff > 180) rotationDiff -= 360;
+        if (rotationDiff < -180) rotationDiff += 360;
+        rotationError[i] = rotationDiff;
+    }
+}
+
+// -------------------- Phase 4: Finish --------------------
+void CarFleet::finish(float dt, int begin, int end) {
+    const int n = end - begin;
+    const int b = begin;
+    rotationKernel(n, dt, hot.rotation.data() + b, rotationError.data() + b, hot.rotationSpeed.data() + b);
+    positionKernel(n, hot.posX.data() + b, hot.posY.data() + b, baseX.data() + b, baseY.data() + b,
+        hot.offsetX.data() + b, hot.offsetY.data() + b, active.data() + b);
+    wheelKernel(n, dt, cold.wheelRotation.data() + b, hot.speed.data() + b, hot.size.data() + b,
+        active.data() + b);
+}
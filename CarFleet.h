@@ -0,0 +1,129 @@
+#pragma once
+#include "Car.h"
+#include "CarCollisions.h"
+#include "LaneOccupancy.h"
+#include "ThreadPool.h"
+#include "Track.h"
+#include "Vector2.h"
+#include <cstdint>
+#include <vector>
+
+// -------------------- CarFleet Class --------------------
+// Structure-of-arrays container for large fields of cars.
+// Car stores every field of a car side by side (~110 bytes), so walking a
+// std::vector<Car> drags colors, wheel state and steering parameters through
+// the cache on every tick. CarFleet keeps each field in its own contiguous array
+// and splits them into a hot set (read/written by step every tick) and a cold
+// set (visual-only data), so the update kernel streams over packed floats that
+// the compiler can vectorise.
+//
+// step() runs in five phases:
+//   1. decide    - per-car scalar pass: front car detection, target speed and
+//                  lane switch decision (neighbours come from the per-lane
+//                  LaneOccupancy index). Cars are bucketed by CarModel and
+//                  each bucket runs the pass specialised for its model
+//   2. integrate - branch-free loops over contiguous arrays: acceleration,
+//                  arc-length advance and lane offset lerp
+//   3. place     - per-car Track table lookups: lap wrap, segment, centre-line
+//                  point and heading error
+//   4. finish    - branch-free loops: rotation smoothing, final position and
+//                  wheel animation
+//   5. collide   - optional, single threaded: CarCollisions over the position,
+//                  rotation and size arrays, pushing overlapping cars apart
+// Because every decision is taken before any car moves, results do not depend
+// on the order cars are stored in, and each pass can be split across a
+// ThreadPool with bit-identical results for any thread count.
+class CarFleet {
+public:
+    // -------------------- Hot State --------------------
+    // Fields touched by every step(), one array per field
+    struct HotState {
+        std::vector<float> posX, posY;            // Position
+        std::vector<float> speed;                 // Current speed magnitude
+        std::vector<float> targetSpeed;           // Desired speed after traffic check
+        std::vector<float> maxSpeed;              // Maximum achievable speed
+        std::vector<float> accelerationFactor;    // Acceleration responsiveness
+        std::vector<float> rotation;              // Orientation in degrees
+        std::vector<float> offsetX, offsetY;      // Offset from the lane centre line
+        std::vector<float> laneSwitchSpeed;       // Lane offset lerp factor
+        std::vector<float> rotationSpeed;         // Rotation smoothing factor
+        std::vector<float> slipFactor;            // Cornering grip lost to slip (Grip model)
+        std::vector<float> size;                  // Half-size (detection radius)
+        std::vector<float> distance;              // Arc length driven on the current lap
+        std::vector<float> lapProgress;           // Fraction of the lap completed
+        std::vector<int> targetIndex;             // Next track point to reach
+        std::vector<int> lap;                     // Completed laps
+        std::vector<int> laneIndex;               // Lane currently occupied
+        std::vector<int> targetLaneIndex;         // Lane the car is switching to
+        std::vector<std::uint8_t> finished;       // Non-zero once the car finished the race
+    };
+
+    // -------------------- Cold State --------------------
+    // Visual-only fields, never read by the decision/integration kernel
+    struct ColdState {
+        std::vector<std::uint8_t> colorR, colorG, colorB; // Body color (0-255)
+        std::vector<float> wheelRotation;                 // Wheel animation angle
+    };
+
+    HotState hot;
+    ColdState cold;
+
+    // -------------------- Collisions --------------------
+    bool collisions;            // Separate overlapping cars after every step (off by default)
+    CarCollisions collider;     // Broadphase state and the last step's contacts
+
+    // -------------------- Constructor --------------------
+    // Creates an empty fleet driving on the given track
+    explicit CarFleet(const Track* track);
+
+    // -------------------- Conversion --------------------
+    // Appends a copy of an AoS car
+    void addCar(const Car& car);
+
+    // Replaces the fleet contents with copies of 'cars'
+    void assign(const std::vector<Car>& cars);
+
+    // Writes the fleet state back into 'cars' (same order as assign/addCar)
+    void storeTo(std::vector<Car>& cars) const;
+
+    // Number of cars in the fleet
+    int count() const { return static_cast<int>(hot.posX.size()); }
+
+    // Indices of the cars driving 'model', ascending
+    const std::vector<int>& modelCars(CarModel model) const { return buckets[static_cast<int>(model)]; }
+
+    // -------------------- Simulation Step --------------------
+    // Advances every car by dt seconds using the batched kernel,
+    // optionally splitting each pass across 'pool'
+    void step(float dt, ThreadPool* pool = nullptr);
+
+private:
+    const Track* track;         // Shared track and arc-length tables (not owned)
+    LaneOccupancy occupancy;    // Cars per lane ordered by progress
+    std::vector<int> buckets[kCarModelCount]; // Car indices per model
+
+    // -------------------- Per-Step Scratch --------------------
+    // Reused between steps to avoid reallocating every tick
+    std::vector<float> baseX, baseY;      // Lane centre-line point at the new distance
+    std::vector<float> rotationError;     // Wrapped heading error (degrees), 0 if finished
+    std::vector<float> active;            // 1 for racing cars, 0 for finished ones
+
+    // Phase 1: front car detection and lane switch decision for cars
+    // ids[begin] .. ids[end - 1], all driving 'Model'
+    template <class Model> void decideTraffic(const int* ids, int begin, int end);
+
+    // Runs decideTraffic for one bucket, optionally across 'pool'
+    template <class Model> void decideBucket(ThreadPool* pool);
+
+    // Moves cars that decided to switch onto their new lane without moving them
+    void commitLaneSwitches(int begin, int end);
+
+    // Phase 2: vectorisable speed / distance / offset integration for cars [begin, end)
+    void integrate(float dt, int begin, int end);
+
+    // Phase 3: lap wrap and track table lookups for cars [begin, end)
+    void placeOnTrack(int begin, int end);
+
+    // Phase 4: vectorisable rotation, position and wheel update for cars [begin, end)
+    void finish(float dt, int begin, int end);
+};
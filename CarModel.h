@@ -0,0 +1,104 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// -------------------- Car Models --------------------
+// Driving behaviour of a car. Every model is a policy struct of static inline
+// rules; Car::update and CarFleet pick the policy once (per car, or per bucket
+// of cars of the same model) and run a kernel specialised for it at compile
+// time, so the inner loop has no virtual calls or per-rule branches.
+enum class CarModel : std::uint8_t {
+    Kinematic,   // Original behaviour: follows the lane at its top speed
+    Grip,        // Slows for corners to the speed its tyres can hold
+    Aggressive   // Follows closer and overtakes on either side
+};
+
+const int kCarModelCount = 3;
+
+// Name used in scenario files and on the command line
+inline const char* carModelName(CarModel model) {
+    switch (model) {
+    case CarModel::Grip: return "grip";
+    case CarModel::Aggressive: return "aggressive";
+    default: return "kinematic";
+    }
+}
+
+// Parses a model name; returns false for an unknown name
+inline bool parseCarModel(const char* name, CarModel& model) {
+    for (int m = 0; m < kCarModelCount; ++m) {
+        if (!strcmp(name, carModelName(static_cast<CarModel>(m)))) {
+            model = static_cast<CarModel>(m);
+            return true;
+        }
+    }
+    return false;
+}
+
+// -------------------- Policy Rules --------------------
+// Every policy provides the following; ranges are multiples of a car's
+// detection radius (twice its half-size):
+//   id             the CarModel value the policy implements
+//   followRange    a car ahead in the same lane is followed inside this range
+//   overtakeRange  a lane change is tried inside this range (<= followRange)
+//   laneClearance  the target lane must be free of cars inside this range
+//   cornering      true if speedLimit() depends on the curvature
+// followSpeed() is the target speed behind a car going 'frontSpeed'.
+// laneCandidate() is the lane to try on attempt 0, then 1 (-1 = none).
+// speedLimit() caps the target speed on a segment of the given curvature.
+
+// Simple kinematic model: the behaviour every car had originally
+struct KinematicModel {
+    static constexpr CarModel id = CarModel::Kinematic;
+    static constexpr float followRange = 2.0f;
+    static constexpr float overtakeRange = 1.5f;
+    static constexpr float laneClearance = 1.0f;
+    static constexpr bool cornering = false;
+
+    static float followSpeed(float frontSpeed) { return std::max(0.5f, frontSpeed - 0.5f); }
+
+    // Left lane first, otherwise the right lane; one attempt
+    static int laneCandidate(int lane, int laneCount, int attempt) {
+        if (attempt > 0) return -1;
+        if (lane > 0) return lane - 1;
+        if (lane < laneCount - 1) return lane + 1;
+        return -1;
+    }
+
+    static float speedLimit(float maxSpeed, float, float) { return maxSpeed; }
+};
+
+// Slip/grip model: traffic rules of the kinematic model, but the speed in a
+// corner is limited by the lateral acceleration the tyres can hold,
+// v = sqrt(grip / curvature), with 'slipFactor' the fraction of grip lost
+struct GripModel : KinematicModel {
+    static constexpr CarModel id = CarModel::Grip;
+    static constexpr bool cornering = true;
+    static constexpr float gripAcceleration = 6.0f; // Lateral grip in units/s^2
+
+    static float speedLimit(float maxSpeed, float curvature, float slipFactor) {
+        float grip = gripAcceleration * (1.0f - slipFactor);
+        if (curvature * maxSpeed * maxSpeed <= grip) return maxSpeed;
+        return std::sqrt(grip / curvature);
+    }
+};
+
+// Aggressive model: closes up to the car ahead, accepts tighter gaps and
+// tries the right lane when the left one is taken
+struct AggressiveModel : KinematicModel {
+    static constexpr CarModel id = CarModel::Aggressive;
+    static constexpr float followRange = 1.5f;
+    static constexpr float overtakeRange = 1.5f;
+    static constexpr float laneClearance = 0.75f;
+
+    static float followSpeed(float frontSpeed) { return std::max(0.5f, frontSpeed - 0.2f); }
+
+    static int laneCandidate(int lane, int laneCount, int attempt) {
+        int first = KinematicModel::laneCandidate(lane, laneCount, 0);
+        if (attempt == 0) return first;
+        if (attempt == 1 && first == lane - 1 && lane < laneCount - 1) return lane + 1;
+        return -1;
+    }
+};
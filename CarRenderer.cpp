@@ -0,0 +1,81 @@
+#include "stdafx.h"
+#include "CarRenderer.h"
+#include "Profiler.h"
+#include <GL/glut.h>
+#include <cmath>
+
+// -------------------- Draw Function --------------------
+// Draws the car as a colored rectangle with simple wheels at its current pose
+void drawCar(const Car& car) {
+    drawCar(car, car.pose());
+}
+
+// Draws the car as a colored rectangle with simple wheels, applying the pose's position and rotation
+void drawCar(const Car& car, const CarPose& pose) {
+    PROFILE_SCOPE("Car::draw");
+    if (car.finished) return; // Skip drawing finished cars
+
+    glPushMatrix();
+    glTranslatef(pose.position.x, pose.position.y, 0.0f); // Move to car position
+    glRotatef(pose.rotation, 0.0f, 0.0f, 1.0f);      // Rotate car according to movement direction
+
+    const float size = car.size; // Half-size of the car body
+
+    // -------------------- Draw Car Body --------------------
+    glColor3ub(car.colorR, car.colorG, car.colorB); // Set car color
+    glBegin(GL_QUADS);
+    glVertex2f(-size, -size);
+    glVertex2f(size, -size);
+    glVertex2f(size, size);
+    glVertex2f(-size, size);
+    glEnd();
+
+    // -------------------- Draw Wheels --------------------
+    float wheelSize = size / 3.0f;
+
+    // Left wheel
+    glPushMatrix();
+    glTranslatef(-size + wheelSize, -size, 0);
+    glRotatef(pose.wheelRotation, 0, 0, 1);
+    glColor3ub(0, 0, 0); // Black wheels
+    glBegin(GL_QUADS);
+    glVertex2f(-wheelSize, -wheelSize);
+    glVertex2f(wheelSize, -wheelSize);
+    glVertex2f(wheelSize, wheelSize);
+    glVertex2f(-wheelSize, wheelSize);
+    glEnd();
+    glPopMatrix();
+
+    // Right wheel
+    glPushMatrix();
+    glTranslatef(size - wheelSize, -size, 0);
+    glRotatef(pose.wheelRotation, 0, 0, 1);
+    glColor3ub(0, 0, 0);
+    glBegin(GL_QUADS);
+    glVertex2f(-wheelSize, -wheelSize);
+    glVertex2f(wheelSize, -wheelSize);
+    glVertex2f(wheelSize, wheelSize);
+    glVertex2f(-wheelSize, wheelSize);
+    glEnd();
+    glPopMatrix();
+
+    glPopMatrix(); // Restore transform
+}
+
+// -------------------- Batched Body --------------------
+// Level-of-detail form for cars only a few pixels wide: the caller wraps any
+// number of these in a single glBegin(GL_QUADS) / glEnd()
+void emitCarBody(const Car& car, const CarPose& pose) {
+    if (car.finished) return;
+
+    const float size = car.size;
+    float radians = pose.rotation * 3.14159265f / 180.0f;
+    float c = std::cos(radians) * size, s = std::sin(radians) * size;
+    float x = pose.position.x, y = pose.position.y;
+
+    glColor3ub(car.colorR, car.colorG, car.colorB);
+    glVertex2f(x - c + s, y - s - c); // (-size, -size)
+    glVertex2f(x + c + s, y + s - c); // ( size, -size)
+    glVertex2f(x + c - s, y + s + c); // ( size,  size)
+    glVertex2f(x - c - s, y - s + c); // (-size,  size)
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include "Car.h"
+
+// -------------------- Car Rendering --------------------
+// OpenGL drawing for Car objects. Kept out of Car.h/Car.cpp so that the
+// simulation core can be built and run without any GL dependency.
+
+// Renders the car body and wheels at the car's current position and rotation
+void drawCar(const Car& car);
+
+// Renders the car at an explicit (e.g. interpolated) pose
+void drawCar(const Car& car, const CarPose& pose);
+
+// Emits the car body only (no wheels) as four GL_QUADS vertices with the
+// corners rotated on the CPU, so many distant cars can share one glBegin/glEnd
+void emitCarBody(const Car& car, const CarPose& pose);
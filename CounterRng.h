@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+
+// -------------------- CounterRng Class --------------------
+// Counter-based random number generator.
+// Every output is a pure function of (seed, stream, counter): the key is
+// derived from seed and stream, and the n-th value is a SplitMix64 hash of
+// key + n * golden ratio. There is no hidden state beyond the counter, so a
+// race can be given its own stream (its race index) and be reproduced exactly,
+// on any thread and in any order, from the batch seed and that index alone.
+class CounterRng {
+public:
+    // -------------------- Constructor --------------------
+    CounterRng(std::uint64_t seed, std::uint64_t stream)
+        : key(mix(seed ^ mix(stream + 0x9E3779B97F4A7C15ull))), counter(0)
+    {
+    }
+
+    // -------------------- Raw Output --------------------
+    // n-th value of this stream, independent of how many values were drawn so far
+    std::uint64_t at(std::uint64_t n) const { return mix(key + (n + 1) * 0x9E3779B97F4A7C15ull); }
+
+    // Next value of this stream
+    std::uint64_t next() { return at(counter++); }
+
+    // -------------------- Distributions --------------------
+    // Uniform float in [0, 1) using the top 24 bits
+    float uniform() { return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f); }
+
+    // Uniform float in [lo, lo + range)
+    float uniform(float lo, float range) { return lo + uniform() * range; }
+
+private:
+    std::uint64_t key;      // Stream key derived from seed and stream id
+    std::uint64_t counter;  // Index of the next value
+
+    // SplitMix64 finaliser
+    static std::uint64_t mix(std::uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
@@ -0,0 +1,40 @@
+// FixedStepClock.cpp : fixed-timestep accumulator.
+// Part of the GL-free simulation core.
+
+#include "FixedStepClock.h"
+#include <cmath>
+
+// -------------------- Constructor --------------------
+FixedStepClock::FixedStepClock(float stepsPerSecond, int maxStepsPerFrame)
+    : stepSeconds(1.0f / stepsPerSecond), maxStepsPerFrame(maxStepsPerFrame), timeScale(1.0f),
+    accumulator(0.0), steps(0), dropped(0.0)
+{
+}
+
+// -------------------- Frame Update --------------------
+int FixedStepClock::advance(double frameSeconds) {
+    if (frameSeconds > 0.0) accumulator += frameSeconds * timeScale;
+
+    // Counted in double: a long stall at a high warp can exceed an int
+    double limit = static_cast<double>(maxStepsPerFrame) * (timeScale > 1.0f ? timeScale : 1.0f);
+    double dueSteps = std::floor(accumulator / stepSeconds);
+    if (dueSteps > limit) {
+        // Too far behind: run the maximum and forget the rest
+        double excess = accumulator - std::floor(limit) * stepSeconds;
+        dropped += excess;
+        accumulator -= excess;
+        dueSteps = std::floor(limit);
+    }
+    int due = static_cast<int>(dueSteps);
+
+    accumulator -= due * static_cast<double>(stepSeconds);
+    if (accumulator < 0.0) accumulator = 0.0; // Guard against rounding
+    steps += due;
+    return due;
+}
+
+void FixedStepClock::discard(int count) {
+    if (count <= 0) return;
+    steps -= count;
+    dropped += count * static_cast<double>(stepSeconds);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// -------------------- FixedStepClock Class --------------------
+// Accumulator that converts measured frame times into a whole number of fixed
+// simulation steps. The simulation always advances by exactly stepSeconds, so
+// sim time tracks wall time regardless of frame rate, and the leftover time
+// (alpha) tells the renderer how far to blend between the last two ticks.
+//
+// If a frame took so long that more than maxStepsPerFrame steps are due (a
+// debugger pause, a window drag, or a simulation that cannot keep up), the
+// excess is dropped instead of being caught up, so a slow frame can never
+// snowball into ever slower frames.
+//
+// timeScale warps time: a frame of real time is worth timeScale frames of
+// simulated time, and the step limit grows with it. A caller that cannot run
+// all the steps of a warped frame in time hands the rest back with discard().
+class FixedStepClock {
+public:
+    float stepSeconds;       // Length of one simulation step
+    int maxStepsPerFrame;    // Most steps run for one frame at 1x (spiral-of-death guard)
+    float timeScale;         // Simulated seconds per real second (1 = real time)
+
+    // -------------------- Constructor --------------------
+    // Steps at 'stepsPerSecond' Hz
+    explicit FixedStepClock(float stepsPerSecond = 240.0f, int maxStepsPerFrame = 16);
+
+    // -------------------- Frame Update --------------------
+    // Adds the real time elapsed since the previous frame and returns the
+    // number of steps the caller must run now
+    int advance(double frameSeconds);
+
+    // Drops 'count' of the steps the last advance() returned, which the
+    // caller did not run (out of frame time)
+    void discard(int count);
+
+    // Fraction of a step accumulated but not yet simulated, in [0, 1)
+    float alpha() const { return static_cast<float>(accumulator / stepSeconds); }
+
+    // -------------------- Statistics --------------------
+    long long totalSteps() const { return steps; }           // Steps handed out so far
+    double droppedSeconds() const { return dropped; }        // Simulated time discarded by the guard or discard()
+
+private:
+    double accumulator;  // Scaled time not yet simulated
+    long long steps;     // Total steps handed out
+    double dropped;      // Total time discarded
+};
@@ -0,0 +1,222 @@
+// FrameWriter.cpp : pipelined PPM/PNG frame sequence writer.
+// Part of the GL-free simulation core.
+
+#include "FrameWriter.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// -------------------- PNG Helpers --------------------
+struct CrcTable {
+    std::uint32_t entries[256];
+    CrcTable() {
+        for (std::uint32_t n = 0; n < 256; ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[n] = c;
+        }
+    }
+};
+
+// CRC-32 of 'size' bytes continuing from 'crc' (PNG chunk checksums)
+static std::uint32_t crc32(std::uint32_t crc, const unsigned char* data, size_t size) {
+    static const CrcTable table; // Built once, thread-safe
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void putBigEndian(std::vector<unsigned char>& out, std::uint32_t value) {
+    out.push_back(static_cast<unsigned char>(value >> 24));
+    out.push_back(static_cast<unsigned char>(value >> 16));
+    out.push_back(static_cast<unsigned char>(value >> 8));
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+// Appends a chunk: length, type, data, CRC of type and data
+static void putChunk(std::vector<unsigned char>& out, const char* type, const unsigned char* data, size_t size) {
+    putBigEndian(out, static_cast<std::uint32_t>(size));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (size) out.insert(out.end(), data, data + size);
+    putBigEndian(out, crc32(0, out.data() + start, size + 4));
+}
+
+// Whole PNG of a bottom-up RGB frame. The image data is a zlib stream of
+// stored deflate blocks (at most 65535 bytes each) over the rows, top row
+// first, each row prefixed with filter type 0.
+static void encodePNG(std::vector<unsigned char>& out, const unsigned char* pixels, int width, int height) {
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.assign(signature, signature + 8);
+
+    unsigned char header[13] = { 0 };
+    for (int i = 0; i < 4; ++i) {
+        header[i] = static_cast<unsigned char>(width >> (24 - 8 * i));
+        header[4 + i] = static_cast<unsigned char>(height >> (24 - 8 * i));
+    }
+    header[8] = 8;  // Bits per channel
+    header[9] = 2;  // Truecolour (RGB)
+    putChunk(out, "IHDR", header, sizeof(header));
+
+    size_t rowBytes = static_cast<size_t>(width) * 3;
+    size_t rawSize = (rowBytes + 1) * height;
+    std::vector<unsigned char> stream;
+    stream.reserve(rawSize + rawSize / 65535 * 5 + 16);
+    stream.push_back(0x78);  // Deflate, 32 KB window
+    stream.push_back(0x01);  // No preset dictionary, fastest level; header is a multiple of 31
+    std::uint32_t a = 1, b = 0; // Adler-32 of the raw data
+    size_t blockLeft = 0, rawLeft = rawSize;
+    auto put = [&](const unsigned char* data, size_t size) {
+        while (size) {
+            if (!blockLeft) {
+                blockLeft = rawLeft < 65535 ? rawLeft : 65535;
+                rawLeft -= blockLeft;
+                stream.push_back(rawLeft ? 0 : 1); // Stored block, final flag on the last
+                stream.push_back(static_cast<unsigned char>(blockLeft));
+                stream.push_back(static_cast<unsigned char>(blockLeft >> 8));
+                stream.push_back(static_cast<unsigned char>(~blockLeft));
+                stream.push_back(static_cast<unsigned char>(~blockLeft >> 8));
+            }
+            size_t take = size < blockLeft ? size : blockLeft;
+            stream.insert(stream.end(), data, data + take);
+            for (size_t i = 0; i < take; ++i) {
+                a += data[i];
+                if (a >= 65521) a -= 65521;
+                b += a;
+                if (b >= 65521) b -= 65521;
+            }
+            data += take;
+            size -= take;
+            blockLeft -= take;
+        }
+    };
+    const unsigned char filter = 0;
+    for (int y = height - 1; y >= 0; --y) {
+        put(&filter, 1);
+        put(pixels + rowBytes * y, rowBytes);
+    }
+    putBigEndian(stream, (b << 16) | a);
+    putChunk(out, "IDAT", stream.data(), stream.size());
+    putChunk(out, "IEND", nullptr, 0);
+}
+
+// -------------------- Constructor / Destructor --------------------
+FrameWriter::FrameWriter()
+    : width(0), height(0), format(Format::PPM), current(-1), nextFrame(0),
+    stopping(false), writeFailed(false)
+{
+}
+
+FrameWriter::~FrameWriter() {
+    close();
+}
+
+// -------------------- Writing --------------------
+void FrameWriter::open(const std::string& outputDirectory, int frameWidth, int frameHeight, Format frameFormat, int bufferCount) {
+    close();
+    directory = outputDirectory;
+    width = frameWidth;
+    height = frameHeight;
+    format = frameFormat;
+    buffers.assign(bufferCount < 1 ? 1 : bufferCount, std::vector<unsigned char>(static_cast<size_t>(width) * height * 3));
+    freeBuffers.clear();
+    for (int i = 0; i < static_cast<int>(buffers.size()); ++i) freeBuffers.push_back(i);
+    queued.clear();
+    current = -1;
+    nextFrame = 0;
+    stopping = false;
+    writeFailed = false;
+    counters = Stats();
+    worker = std::thread(&FrameWriter::writerLoop, this);
+}
+
+unsigned char* FrameWriter::acquire() {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this] { return !freeBuffers.empty(); });
+    current = freeBuffers.front();
+    freeBuffers.pop_front();
+    counters.waitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return buffers[current].data();
+}
+
+void FrameWriter::submit() {
+    if (current < 0) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued.push_back({ current, nextFrame++ });
+        current = -1;
+    }
+    changed.notify_all();
+}
+
+bool FrameWriter::close() {
+    if (!worker.joinable()) return !writeFailed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    worker.join();
+    return !writeFailed;
+}
+
+// -------------------- Writer Thread --------------------
+// After a failed write the remaining frames are dropped, but their buffers
+// still go back to the pool so acquire() cannot wait forever
+void FrameWriter::writerLoop() {
+    for (;;) {
+        std::pair<int, int> frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this] { return stopping || !queued.empty(); });
+            if (queued.empty()) return;
+            frame = queued.front();
+            queued.pop_front();
+        }
+
+        if (!writeFailed) {
+            auto start = std::chrono::steady_clock::now();
+            if (writeFrame(buffers[frame.first].data(), frame.second)) ++counters.frames;
+            else writeFailed = true;
+            counters.writeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            freeBuffers.push_back(frame.first);
+        }
+        changed.notify_all();
+    }
+}
+
+bool FrameWriter::writeFrame(const unsigned char* pixels, int number) {
+    char name[32];
+    snprintf(name, sizeof(name), "frame_%05d.%s", number, format == Format::PNG ? "png" : "ppm");
+    std::string path = directory.empty() ? name : directory + "/" + name;
+
+    if (format == Format::PNG) encodePNG(encoded, pixels, width, height);
+    else {
+        // P6 header, then the rows top first
+        char header[32];
+        int headerSize = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", width, height);
+        size_t rowBytes = static_cast<size_t>(width) * 3;
+        encoded.resize(headerSize + rowBytes * height);
+        memcpy(encoded.data(), header, headerSize);
+        unsigned char* out = encoded.data() + headerSize;
+        for (int y = height - 1; y >= 0; --y, out += rowBytes)
+            memcpy(out, pixels + rowBytes * y, rowBytes);
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        printf("Error: cannot create frame file %s\n", path.c_str());
+        return false;
+    }
+    bool ok = fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+    ok = fclose(file) == 0 && ok;
+    if (!ok) printf("Error: failed writing frame file %s\n", path.c_str());
+    else counters.bytes += encoded.size();
+    return ok;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -------------------- FrameWriter Class --------------------
+// Writes rendered frames as numbered image files on a background thread, so
+// encoding and disk writes overlap with rendering the next frames.
+//
+// Frames live in a fixed pool of RGB buffers. The renderer takes a free
+// buffer with acquire(), fills it (rows bottom-up, as glReadPixels returns
+// them) and hands it over with submit(). The writer thread flips, encodes and
+// writes each frame in submission order and returns its buffer to the pool.
+// When every buffer is still queued, acquire() waits: a writer slower than
+// the renderer holds the renderer back instead of growing memory.
+//
+// Files are "frame_00000.ppm" (binary P6) or "frame_00000.png" in the output
+// directory. PNGs use stored (uncompressed) deflate blocks: no compression
+// library is needed and encoding stays as cheap as PPM.
+class FrameWriter {
+public:
+    enum class Format { PPM, PNG };
+
+    static const int kDefaultBufferCount = 4; // Frames that may wait for the writer
+
+    // -------------------- Statistics --------------------
+    struct Stats {
+        int frames = 0;            // Frames written
+        size_t bytes = 0;          // File bytes written
+        double writeSeconds = 0;   // Writer thread time spent encoding and writing
+        double waitSeconds = 0;    // Time acquire() waited for a free buffer
+    };
+
+    FrameWriter();
+    ~FrameWriter();   // Finishes the queued frames
+
+    FrameWriter(const FrameWriter&) = delete;
+    FrameWriter& operator=(const FrameWriter&) = delete;
+
+    // -------------------- Writing --------------------
+    // Starts the writer thread for width x height frames into 'directory'
+    // (which must exist)
+    void open(const std::string& directory, int width, int height, Format format,
+        int bufferCount = kDefaultBufferCount);
+
+    // A free width * height * 3 byte RGB buffer for the next frame
+    unsigned char* acquire();
+
+    // Queues the buffer returned by the last acquire() as the next frame
+    void submit();
+
+    // Writes the queued frames and stops the thread; false if any file could
+    // not be written (the writer stops at the first failure)
+    bool close();
+
+    // True once a frame could not be written; later frames are dropped
+    bool failed() const { return writeFailed; }
+
+    const Stats& stats() const { return counters; } // Complete after close()
+
+private:
+    std::string directory;
+    int width, height;
+    Format format;
+    std::vector<std::vector<unsigned char>> buffers;
+    std::vector<unsigned char> encoded;   // File bytes of the frame being written (writer thread)
+    int current;                          // Buffer handed out by acquire(), -1 if none
+    int nextFrame;                        // Number of the next submitted frame
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable changed;      // A buffer was queued or freed, or stopping
+    std::deque<int> freeBuffers;
+    std::deque<std::pair<int, int>> queued; // (buffer, frame number) waiting to be written
+    bool stopping;
+    std::atomic<bool> writeFailed;
+    Stats counters;
+
+    void writerLoop();
+
+    // Encodes 'pixels' into 'encoded' and writes frame 'number'; false on a write error
+    bool writeFrame(const unsigned char* pixels, int number);
+};
@@ -0,0 +1,136 @@
+// Image.cpp : BMP decoding and channel swizzling.
+// Part of the GL-free simulation core (shared by the GLUT front end's texture loader).
+
+#include "Image.h"
+#include <cstdint>
+#include <cstring>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+// -------------------- Constructor --------------------
+Image::Image()
+    : width(0), height(0), channels(0), rowStride(0), pixels(nullptr)
+{
+}
+
+// Little-endian field readers for the BMP headers
+static std::uint32_t readU32(const unsigned char* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+static std::uint16_t readU16(const unsigned char* p) {
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+// BI_BITFIELDS channel masks: red, green and blue follow the 40-byte info
+// header (inside it for V2 headers and later), alpha follows them from V3 on.
+// The pixels are uploaded as BGRA, so only the masks of that byte order are
+// accepted; alpha may also be absent.
+static bool hasBGRAMasks(const unsigned char* data, size_t size, std::uint32_t headerSize) {
+    const size_t masks = 14 + 40;
+    if (size < masks + 12) return false;
+    if (readU32(data + masks) != 0x00FF0000u || readU32(data + masks + 4) != 0x0000FF00u ||
+        readU32(data + masks + 8) != 0x000000FFu)
+        return false;
+    if (headerSize < 56) return true;
+    if (size < masks + 16) return false;
+    std::uint32_t alpha = readU32(data + masks + 12);
+    return alpha == 0xFF000000u || alpha == 0;
+}
+
+// -------------------- BMP Loading --------------------
+// File header (14 bytes) followed by a BITMAPINFOHEADER or later (>= 40 bytes).
+// A negative height marks a top-down bitmap, whose rows are reversed into
+// 'storage'; otherwise the pixels are used straight from the mapping.
+bool Image::loadBMP(const std::string& path) {
+    storage.clear();
+    pixels = nullptr;
+    width = height = channels = rowStride = 0;
+    if (!file.open(path)) return false;
+
+    const unsigned char* data = file.data();
+    size_t size = file.size();
+    if (size < 54 || data[0] != 'B' || data[1] != 'M') return false;
+
+    std::uint32_t dataOffset = readU32(data + 10);
+    std::uint32_t headerSize = readU32(data + 14);
+    std::int32_t fileWidth = static_cast<std::int32_t>(readU32(data + 18));
+    std::int32_t fileHeight = static_cast<std::int32_t>(readU32(data + 22));
+    std::uint16_t bitsPerPixel = readU16(data + 28);
+    std::uint32_t compression = headerSize >= 40 ? readU32(data + 30) : 0;
+
+    // Uncompressed (BI_RGB) or BI_BITFIELDS with the standard masks, 24/32 bit
+    if (headerSize < 40 || fileWidth <= 0 || fileHeight == 0) return false;
+    if (bitsPerPixel != 24 && bitsPerPixel != 32) return false;
+    if (compression != 0 && !(compression == 3 && bitsPerPixel == 32)) return false;
+    if (compression == 3 && !hasBGRAMasks(data, size, headerSize)) return false;
+
+    bool topDown = fileHeight < 0;
+    width = fileWidth;
+    height = topDown ? -fileHeight : fileHeight;
+    channels = bitsPerPixel / 8;
+    rowStride = (width * channels + 3) & ~3; // Rows are padded to 4 bytes
+    if (dataOffset > size || byteSize() > size - dataOffset) {
+        width = height = channels = rowStride = 0;
+        return false;
+    }
+
+    const unsigned char* first = data + dataOffset;
+    if (!topDown) {
+        pixels = first; // Zero-copy: already bottom-up with GL-compatible padding
+        return true;
+    }
+
+    storage.resize(byteSize());
+    for (int row = 0; row < height; ++row)
+        memcpy(&storage[static_cast<size_t>(row) * rowStride], first + static_cast<size_t>(height - 1 - row) * rowStride, rowStride);
+    pixels = storage.data();
+    file.close();
+    return true;
+}
+
+// -------------------- Ownership --------------------
+void Image::takeOwnership() {
+    if (!pixels || (!storage.empty() && pixels == storage.data())) return;
+    storage.assign(pixels, pixels + byteSize());
+    pixels = storage.data();
+    file.close();
+}
+
+// -------------------- Red/Blue Swap --------------------
+// Each row is processed separately so the padding bytes are never touched.
+// The SSSE3 path shuffles 16 bytes at a time: five 3-byte or four 4-byte
+// pixels per step, with a scalar loop for the rest of the row.
+void Image::swapRedBlue() {
+    takeOwnership();
+    if (storage.empty()) return;
+
+    int rowBytes = width * channels;
+    for (int row = 0; row < height; ++row) {
+        unsigned char* p = &storage[static_cast<size_t>(row) * rowStride];
+        int x = 0;
+#ifdef __SSSE3__
+        if (channels == 3) {
+            const __m128i swap3 = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+            for (; x + 16 <= rowBytes; x += 15) { // Byte 15 is kept and redone next step
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + x));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(p + x), _mm_shuffle_epi8(v, swap3));
+            }
+        }
+        else {
+            const __m128i swap4 = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+            for (; x + 16 <= rowBytes; x += 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + x));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(p + x), _mm_shuffle_epi8(v, swap4));
+            }
+        }
+#endif
+        for (; x + channels <= rowBytes; x += channels) {
+            unsigned char tmp = p[x];
+            p[x] = p[x + 2];
+            p[x + 2] = tmp;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "MappedFile.h"
+#include <string>
+#include <vector>
+
+// -------------------- Image Class --------------------
+// Decoded image ready for texture upload, without any GL dependency so that
+// decoding can run anywhere (e.g. off the render thread).
+//
+// Pixels keep the file's channel order (BGR or BGRA for BMP) and its row
+// layout: rows are stored bottom-up, as OpenGL expects, and each row is
+// rowStride bytes long (padded to a multiple of 4, which matches GL's default
+// GL_UNPACK_ALIGNMENT). For the common bottom-up BMP the pixels are used in
+// place from the memory-mapped file, so loading copies nothing.
+class Image {
+public:
+    int width;                    // Pixels per row
+    int height;                   // Number of rows
+    int channels;                 // 3 = BGR, 4 = BGRA
+    int rowStride;                // Bytes from one row to the next
+    const unsigned char* pixels;  // First byte of the bottom row (nullptr when empty)
+
+    Image();
+
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+
+    // -------------------- Loading --------------------
+    // Loads an uncompressed 24- or 32-bit BMP; returns false if the file is
+    // missing or in an unsupported format (palettes, compression, 32-bit
+    // bitfields other than BGRA order)
+    bool loadBMP(const std::string& path);
+
+    // Total pixel bytes including row padding
+    size_t byteSize() const { return static_cast<size_t>(rowStride) * height; }
+
+    // -------------------- Channel Order --------------------
+    // Swaps the red and blue channels of every pixel (BGR <-> RGB), for GL
+    // implementations without BGR upload. Copies the pixels out of the file
+    // mapping first if needed. Uses SSSE3 byte shuffles when available.
+    void swapRedBlue();
+
+private:
+    MappedFile file;                    // Source file, mapped for the image's lifetime
+    std::vector<unsigned char> storage; // Owned pixels when they cannot stay in the mapping
+
+    // Makes 'pixels' point at a writable copy in 'storage'
+    void takeOwnership();
+};
@@ -0,0 +1,116 @@
+// LaneOccupancy.cpp : per-lane progress-ordered car index.
+// Part of the GL-free simulation core.
+
+#include "LaneOccupancy.h"
+#include <algorithm>
+
+// -------------------- Constructor --------------------
+LaneOccupancy::LaneOccupancy()
+{
+}
+
+// -------------------- Update --------------------
+// Moves cars that changed lane, refreshes keys and re-sorts each lane
+void LaneOccupancy::update(int laneCount, int carCount, const int* laneOf, const float* keyOf) {
+    // A different field size or lane count invalidates the whole index
+    if (static_cast<int>(lanes.size()) != laneCount || static_cast<int>(laneOfCar.size()) != carCount) {
+        lanes.assign(laneCount, LaneList());
+        laneOfCar.assign(carCount, -1);
+        slotOfCar.assign(carCount, -1);
+    }
+
+    // -------------------- Lane Membership --------------------
+    // Remove cars that left a lane (order of the remaining ids is preserved)
+    for (auto& list : lanes) {
+        size_t kept = 0;
+        for (size_t s = 0; s < list.ids.size(); ++s) {
+            int car = list.ids[s];
+            if (laneOf[car] == laneOfCar[car]) list.ids[kept++] = car;
+            else laneOfCar[car] = -1;
+        }
+        list.ids.resize(kept);
+    }
+
+    // File cars that are new or just changed lane
+    for (int car = 0; car < carCount; ++car) {
+        if (laneOfCar[car] == laneOf[car]) continue;
+        laneOfCar[car] = laneOf[car];
+        lanes[laneOf[car]].ids.push_back(car);
+    }
+
+    // -------------------- Re-Sort --------------------
+    // Insertion sort on (key, id); nearly sorted input makes this linear.
+    // Heavily shuffled lanes (first fill, mass lane changes) use a full sort.
+    for (auto& list : lanes) {
+        std::vector<int>& ids = list.ids;
+        std::vector<float>& keys = list.keys;
+        keys.resize(ids.size());
+        for (size_t s = 0; s < ids.size(); ++s)
+            keys[s] = keyOf[ids[s]];
+
+        size_t descents = 0;
+        for (size_t s = 1; s < ids.size(); ++s)
+            if (keys[s - 1] > keys[s]) ++descents;
+
+        if (descents > ids.size() / 8 + 8) {
+            std::sort(ids.begin(), ids.end(), [keyOf](int a, int b) {
+                return keyOf[a] < keyOf[b] || (keyOf[a] == keyOf[b] && a < b);
+            });
+            for (size_t s = 0; s < ids.size(); ++s)
+                keys[s] = keyOf[ids[s]];
+        }
+
+        for (size_t s = 1; s < ids.size(); ++s) {
+            int id = ids[s];
+            float key = keys[s];
+            size_t t = s;
+            while (t > 0 && (keys[t - 1] > key || (keys[t - 1] == key && ids[t - 1] > id))) {
+                ids[t] = ids[t - 1];
+                keys[t] = keys[t - 1];
+                --t;
+            }
+            ids[t] = id;
+            keys[t] = key;
+        }
+
+        for (size_t s = 0; s < ids.size(); ++s)
+            slotOfCar[ids[s]] = static_cast<int>(s);
+    }
+}
+
+// -------------------- Car Ahead --------------------
+// Next entry in the lane list, wrapping from the end of the lap to its start
+int LaneOccupancy::ahead(int car) const {
+    if (car < 0 || car >= static_cast<int>(laneOfCar.size()) || laneOfCar[car] < 0) return -1;
+    const LaneList& list = lanes[laneOfCar[car]];
+    int n = static_cast<int>(list.ids.size());
+    if (n < 2) return -1;
+    return list.ids[(slotOfCar[car] + 1) % n];
+}
+
+// -------------------- Neighbours Of A Key --------------------
+// Binary search for the first entry at or beyond 'key', then step around 'exclude'
+void LaneOccupancy::neighbours(int lane, float key, int exclude, int& behind, int& aheadCar) const {
+    behind = -1;
+    aheadCar = -1;
+    if (lane < 0 || lane >= static_cast<int>(lanes.size())) return;
+
+    const LaneList& list = lanes[lane];
+    int n = static_cast<int>(list.ids.size());
+    bool excludeHere = exclude >= 0 && exclude < static_cast<int>(laneOfCar.size()) && laneOfCar[exclude] == lane;
+    if (n - (excludeHere ? 1 : 0) == 0) return;
+
+    int first = static_cast<int>(std::lower_bound(list.keys.begin(), list.keys.end(), key) - list.keys.begin());
+
+    // Walk forward (cyclically) to the first car that is not 'exclude' (at most two steps)
+    for (int step = 0; step < n; ++step) {
+        int id = list.ids[(first + step) % n];
+        if (id != exclude) { aheadCar = id; break; }
+    }
+
+    // Walk backward (cyclically) from the entry before 'first'
+    for (int step = 1; step <= n; ++step) {
+        int id = list.ids[((first - step) % n + n) % n];
+        if (id != exclude) { behind = id; break; }
+    }
+}
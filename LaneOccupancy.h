@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+
+// -------------------- LaneOccupancy Class --------------------
+// Per-lane index of cars ordered by track progress.
+// Each lane keeps its cars sorted by a progress key, the fraction of the lap
+// covered in [0, 1), which makes the order cyclic: the car "ahead" of the last entry is the first one.
+// Comparing keys on the ring instead of raw targetIndex values keeps the
+// ordering correct across the lap wrap.
+//
+// The arrays are rebuilt incrementally: cars that changed lane are moved
+// between lanes, then each lane is re-sorted with insertion sort. Between two
+// ticks cars barely move relative to each other, so the arrays are almost
+// sorted and the rebuild is O(N) rather than O(N log N).
+//
+// Queries:
+//   ahead(car)                 - O(1) next car in the same lane
+//   neighbours(lane, key, ...) - O(log N) cars just behind/ahead of a key
+class LaneOccupancy {
+public:
+    // -------------------- Constructor --------------------
+    LaneOccupancy();
+
+    // -------------------- Update --------------------
+    // Refreshes the index with each car's lane and progress key.
+    // Keys are lap progress in [0, 1), so they are comparable between lanes of
+    // different lengths.
+    void update(int laneCount, int carCount, const int* laneOf, const float* keyOf);
+
+    // -------------------- Queries --------------------
+    // Car directly ahead of 'car' in its lane (cyclic), or -1 if it is alone
+    int ahead(int car) const;
+
+    // Cars closest behind and ahead of 'key' on 'lane', skipping 'exclude'.
+    // Either output is -1 if the lane holds no other car.
+    void neighbours(int lane, float key, int exclude, int& behind, int& aheadCar) const;
+
+    // Number of cars currently indexed on a lane
+    int laneSize(int lane) const { return static_cast<int>(lanes[lane].ids.size()); }
+
+private:
+    // -------------------- Per-Lane Storage --------------------
+    // Car ids and their keys, sorted by key (parallel arrays for cache-friendly search)
+    struct LaneList {
+        std::vector<int> ids;
+        std::vector<float> keys;
+    };
+
+    std::vector<LaneList> lanes;   // One sorted list per lane
+    std::vector<int> laneOfCar;    // Lane each car was filed under (-1 = not indexed)
+    std::vector<int> slotOfCar;    // Position of each car inside its lane list
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// -------------------- MappedFile Class --------------------
+// Read-only memory mapping of a whole file (mmap on POSIX, a file mapping
+// object on Windows). Used to load compiled caches without copying them
+// through stdio buffers; the pages are only read in as they are touched.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // -------------------- Mapping --------------------
+    // Maps 'path'; returns false if it cannot be opened or is empty
+    bool open(const std::string& path);
+
+    // Unmaps the file (also done by the destructor)
+    void close();
+
+    // -------------------- Access --------------------
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const unsigned char* bytes; // Start of the mapping, nullptr when closed
+    size_t length;              // Mapped size in bytes
+#ifdef _WIN32
+    void* fileHandle;           // HANDLE of the open file
+    void* mappingHandle;        // HANDLE of the file mapping object
+#endif
+};
@@ -0,0 +1,96 @@
+#include "stdafx.h"
+#include "OffscreenContext.h"
+
+// HAVE_EGL is defined by the build when EGL is found; without it create()
+// always fails and --render is unavailable
+#ifdef HAVE_EGL
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#endif
+
+// -------------------- Constructor / Destructor --------------------
+OffscreenContext::OffscreenContext()
+    : display(nullptr), surface(nullptr), context(nullptr), surfaceWidth(0), surfaceHeight(0)
+{
+}
+
+OffscreenContext::~OffscreenContext() {
+    destroy();
+}
+
+// -------------------- Context Creation --------------------
+bool OffscreenContext::create(int width, int height) {
+    destroy();
+#ifndef HAVE_EGL
+    (void)width;
+    (void)height;
+    printf("Error: offscreen rendering needs EGL, and this build has none\n");
+    return false;
+#else
+    // Prefer the surfaceless platform: it works with no display server at all
+    EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (clientExtensions && strstr(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay)
+            eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (eglDisplay == EGL_NO_DISPLAY) eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, nullptr, nullptr)) {
+        printf("Error: no EGL display for offscreen rendering\n");
+        return false;
+    }
+    display = eglDisplay;
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount < 1) {
+        printf("Error: no EGL config with desktop OpenGL pbuffers\n");
+        destroy();
+        return false;
+    }
+
+    const EGLint surfaceAttributes[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+    surface = eglCreatePbufferSurface(eglDisplay, config, surfaceAttributes);
+    if (surface == EGL_NO_SURFACE) {
+        printf("Error: cannot create a %dx%d offscreen surface\n", width, height);
+        surface = nullptr;
+        destroy();
+        return false;
+    }
+
+    eglBindAPI(EGL_OPENGL_API);
+    context = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, nullptr);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(eglDisplay, surface, surface, context)) {
+        printf("Error: cannot create an offscreen OpenGL context\n");
+        if (context == EGL_NO_CONTEXT) context = nullptr;
+        destroy();
+        return false;
+    }
+    surfaceWidth = width;
+    surfaceHeight = height;
+    return true;
+#endif
+}
+
+void OffscreenContext::destroy() {
+#ifdef HAVE_EGL
+    if (!display) return;
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context) eglDestroyContext(display, context);
+    if (surface) eglDestroySurface(display, surface);
+    eglTerminate(display);
+#endif
+    display = surface = context = nullptr;
+    surfaceWidth = surfaceHeight = 0;
+}
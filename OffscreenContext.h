@@ -0,0 +1,35 @@
+#pragma once
+
+// -------------------- OffscreenContext Class --------------------
+// An OpenGL context without a window, for rendering frames in batch jobs.
+// Uses EGL: the Mesa surfaceless platform when the driver offers it (no X
+// server or GPU needed, llvmpipe renders in software), otherwise the default
+// EGL display. Frames are drawn into a width x height pbuffer, read back with
+// glReadPixels. The context is a desktop (compatibility) OpenGL one, so the
+// same fixed-function drawing code as the GLUT window runs unchanged.
+// Builds without EGL (HAVE_EGL undefined) keep the class, but create() fails.
+class OffscreenContext {
+public:
+    OffscreenContext();
+    ~OffscreenContext();
+
+    OffscreenContext(const OffscreenContext&) = delete;
+    OffscreenContext& operator=(const OffscreenContext&) = delete;
+
+    // Creates the context and makes it current; returns false (printing the
+    // reason) if EGL or a desktop GL context is not available
+    bool create(int width, int height);
+
+    // Releases the context (also done by the destructor)
+    void destroy();
+
+    int width() const { return surfaceWidth; }
+    int height() const { return surfaceHeight; }
+
+private:
+    void* display;    // EGLDisplay
+    void* surface;    // EGLSurface (pbuffer)
+    void* context;    // EGLContext
+    int surfaceWidth;
+    int surfaceHeight;
+};
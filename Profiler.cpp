@@ -0,0 +1,200 @@
+// Profiler.cpp : phase timers, histograms and Chrome trace export.
+// Part of the GL-free simulation core.
+
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+Profiler g_profiler;
+
+// -------------------- Constructor --------------------
+Profiler::Profiler()
+    : on(false), epochNs(nowNs())
+{
+}
+
+// -------------------- Control --------------------
+void Profiler::setEnabled(bool enable) {
+    if (enable && !enabled()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool empty = true;
+        for (const auto& log : logs)
+            if (!log->events.empty()) empty = false;
+        if (empty) epochNs = nowNs(); // A fresh trace starts at zero
+    }
+    on.store(enable, std::memory_order_relaxed);
+}
+
+void Profiler::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& log : logs) {
+        std::fill(log->buckets.begin(), log->buckets.end(), 0u);
+        std::fill(log->calls.begin(), log->calls.end(), 0);
+        std::fill(log->totalNs.begin(), log->totalNs.end(), 0);
+        std::fill(log->maxNs.begin(), log->maxNs.end(), 0);
+        log->events.clear();
+        log->droppedEvents = 0;
+    }
+    epochNs = nowNs();
+}
+
+// -------------------- Recording --------------------
+int Profiler::phaseId(const char* name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < phaseNames.size(); ++i)
+        if (std::string(phaseNames[i]) == name) return static_cast<int>(i);
+    if (static_cast<int>(phaseNames.size()) == kMaxPhases) {
+        printf("Error: more than %d profiler phases, '%s' is not recorded\n", kMaxPhases, name);
+        return -1;
+    }
+    phaseNames.push_back(name);
+    return static_cast<int>(phaseNames.size()) - 1;
+}
+
+std::uint64_t Profiler::nowNs() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// The calling thread's log, created on its first sample
+Profiler::ThreadLog& Profiler::threadLog() {
+    thread_local Profiler* owner = nullptr;
+    thread_local ThreadLog* cached = nullptr;
+    if (owner == this) return *cached;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<ThreadLog> log(new ThreadLog());
+    log->threadIndex = static_cast<int>(logs.size());
+    log->buckets.assign(static_cast<size_t>(kMaxPhases) * kBucketCount, 0u);
+    log->calls.assign(kMaxPhases, 0);
+    log->totalNs.assign(kMaxPhases, 0);
+    log->maxNs.assign(kMaxPhases, 0);
+    log->droppedEvents = 0;
+    cached = log.get();
+    owner = this;
+    logs.push_back(std::move(log));
+    return *cached;
+}
+
+void Profiler::record(int phase, std::uint64_t startNs, std::uint64_t endNs) {
+    if (phase < 0) return;
+    std::uint64_t duration = endNs > startNs ? endNs - startNs : 0;
+
+    ThreadLog& log = threadLog();
+    ++log.buckets[static_cast<size_t>(phase) * kBucketCount + bucketOf(duration)];
+    ++log.calls[phase];
+    log.totalNs[phase] += duration;
+    log.maxNs[phase] = std::max(log.maxNs[phase], duration);
+    if (log.events.size() < kMaxTraceEvents)
+        log.events.push_back({ static_cast<std::uint32_t>(phase), startNs, duration });
+    else
+        ++log.droppedEvents;
+}
+
+// -------------------- Histogram Buckets --------------------
+// Durations below 8 ns get a bucket each; above that every power of two is
+// split into kBucketsPerOctave equal steps
+int Profiler::bucketOf(std::uint64_t ns) {
+    if (ns < 8) return static_cast<int>(ns);
+    int octave = 63;
+    while (!(ns >> octave)) --octave;
+    int step = static_cast<int>((ns >> (octave - 2)) & 3);
+    return std::min(octave * kBucketsPerOctave + step, kBucketCount - 1);
+}
+
+// Largest duration that falls into 'bucket', in microseconds
+double Profiler::bucketUpperUs(int bucket) {
+    if (bucket < 8) return bucket / 1000.0;
+    int octave = bucket / kBucketsPerOctave, step = bucket % kBucketsPerOctave;
+    return std::ldexp(5.0 + step, octave - 2) / 1000.0;
+}
+
+// -------------------- Output --------------------
+// Percentiles are the upper edge of the bucket holding them, capped at the
+// maximum, so they overstate the true value by less than one bucket width
+std::vector<Profiler::PhaseReport> Profiler::report() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<PhaseReport> phases;
+    std::vector<long long> histogram(kBucketCount);
+
+    for (size_t p = 0; p < phaseNames.size(); ++p) {
+        PhaseReport phase = { phaseNames[p], 0, 0.0, 0.0, 0.0, 0.0 };
+        std::fill(histogram.begin(), histogram.end(), 0);
+        std::uint64_t totalNs = 0, maxNs = 0;
+        for (const auto& log : logs) {
+            phase.calls += log->calls[p];
+            totalNs += log->totalNs[p];
+            maxNs = std::max(maxNs, log->maxNs[p]);
+            for (int b = 0; b < kBucketCount; ++b)
+                histogram[b] += log->buckets[p * kBucketCount + b];
+        }
+        if (!phase.calls) continue;
+
+        phase.totalUs = totalNs / 1000.0;
+        phase.maxUs = maxNs / 1000.0;
+        auto percentile = [&](double q) {
+            long long rank = static_cast<long long>(std::ceil(q * phase.calls));
+            long long seen = 0;
+            for (int b = 0; b < kBucketCount; ++b) {
+                seen += histogram[b];
+                if (seen >= rank) return std::min(bucketUpperUs(b), phase.maxUs);
+            }
+            return phase.maxUs;
+        };
+        phase.p50Us = percentile(0.50);
+        phase.p99Us = percentile(0.99);
+        phases.push_back(phase);
+    }
+    return phases;
+}
+
+void Profiler::printReport() const {
+    std::vector<PhaseReport> phases = report();
+    if (phases.empty()) {
+        printf("Profiler: no samples\n");
+        return;
+    }
+    printf("%-22s %10s %10s %10s %10s %12s\n", "phase", "calls", "p50 us", "p99 us", "max us", "total ms");
+    for (const auto& phase : phases) {
+        printf("%-22s %10lld %10.2f %10.2f %10.2f %12.3f\n", phase.name.c_str(), phase.calls,
+            phase.p50Us, phase.p99Us, phase.maxUs, phase.totalUs / 1000.0);
+    }
+
+    long long dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& log : logs) dropped += log->droppedEvents;
+    }
+    if (dropped) printf("(%lld trace events past the buffer limit are only in the histograms)\n", dropped);
+}
+
+// Complete ("X") events with microsecond timestamps relative to the epoch,
+// plus one thread_name metadata event per thread
+bool Profiler::writeTrace(const std::string& path) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        printf("Error: cannot write trace file %s\n", path.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (const auto& log : logs) {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+            first ? "" : ",\n", log->threadIndex, log->threadIndex);
+        first = false;
+        for (const auto& event : log->events) {
+            double ts = (static_cast<double>(event.startNs) - static_cast<double>(epochNs)) / 1000.0;
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                phaseNames[event.phase], log->threadIndex, ts, event.durationNs / 1000.0);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    bool ok = !ferror(file);
+    if (fclose(file) != 0) ok = false;
+    if (!ok) printf("Error: failed writing trace file %s\n", path.c_str());
+    return ok;
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// -------------------- Profiler Class --------------------
+// Scoped timers for the phases of a frame (simulation step, neighbour search,
+// track, cars, text, sidebar). Instrumented code opens a scope with
+//
+//     PROFILE_SCOPE("Track::draw");
+//
+// which, while profiling is enabled, times the rest of the enclosing block and
+// records it twice: in a per-phase latency histogram (for p50/p99/max) and as
+// an event in a bounded trace buffer that writeTrace() exports as Chrome
+// trace JSON (chrome://tracing, Perfetto).
+//
+// While disabled a scope costs one relaxed atomic load and a branch; building
+// with DRS_NO_PROFILER removes the scopes entirely.
+//
+// Each thread records into its own log, so pool threads never contend. The
+// logs are read by report(), printReport(), writeTrace() and reset(), which
+// must only be called while no instrumented code is running (between frames,
+// after a headless run).
+class Profiler {
+public:
+    static const int kMaxPhases = 64;             // Distinct scope names
+    static const int kBucketsPerOctave = 4;       // Histogram resolution (~19% wide buckets)
+    static const int kBucketCount = 40 * kBucketsPerOctave; // 1 ns up to ~18 minutes
+    static const size_t kMaxTraceEvents = 1 << 20; // Per thread; later events only reach the histograms
+
+    // Summary of one phase, durations in microseconds
+    struct PhaseReport {
+        std::string name;
+        long long calls;
+        double totalUs;
+        double p50Us;
+        double p99Us;
+        double maxUs;
+    };
+
+    Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // -------------------- Control --------------------
+    bool enabled() const { return on.load(std::memory_order_relaxed); }
+    void setEnabled(bool enable);
+
+    // Drops all recorded samples and trace events
+    void reset();
+
+    // -------------------- Recording --------------------
+    // Id of the phase called 'name' (registered on first use). 'name' must
+    // outlive the profiler; PROFILE_SCOPE passes string literals.
+    int phaseId(const char* name);
+
+    // Adds one sample of 'phase' running from startNs to endNs (nowNs() clock)
+    void record(int phase, std::uint64_t startNs, std::uint64_t endNs);
+
+    // Monotonic clock in nanoseconds
+    static std::uint64_t nowNs();
+
+    // -------------------- Output --------------------
+    // Phases with at least one sample, in registration order
+    std::vector<PhaseReport> report() const;
+
+    // Prints report() as a table
+    void printReport() const;
+
+    // Writes the trace events as Chrome trace JSON; returns false if the file
+    // cannot be written
+    bool writeTrace(const std::string& path) const;
+
+private:
+    struct TraceEvent {
+        std::uint32_t phase;
+        std::uint64_t startNs;
+        std::uint64_t durationNs;
+    };
+
+    // Samples recorded by one thread
+    struct ThreadLog {
+        int threadIndex;                           // Trace "tid"
+        std::vector<std::uint32_t> buckets;        // kMaxPhases x kBucketCount counts
+        std::vector<long long> calls;              // Per phase
+        std::vector<std::uint64_t> totalNs;        // Per phase
+        std::vector<std::uint64_t> maxNs;          // Per phase
+        std::vector<TraceEvent> events;
+        long long droppedEvents;                   // Events past kMaxTraceEvents
+    };
+
+    std::atomic<bool> on;
+    std::uint64_t epochNs;                         // Trace time zero (last enable or reset)
+    mutable std::mutex mutex;                      // Guards phaseNames and logs
+    std::vector<const char*> phaseNames;
+    std::vector<std::unique_ptr<ThreadLog>> logs;  // Kept after their thread exits
+
+    ThreadLog& threadLog();
+    static int bucketOf(std::uint64_t ns);
+    static double bucketUpperUs(int bucket);
+};
+
+extern Profiler g_profiler;
+
+// -------------------- ProfileScope Class --------------------
+// Records the time from construction to destruction under 'phase', if the
+// profiler was enabled at construction
+class ProfileScope {
+public:
+    explicit ProfileScope(int phase)
+        : phase(g_profiler.enabled() ? phase : -1), start(this->phase >= 0 ? Profiler::nowNs() : 0) {}
+    ~ProfileScope() {
+        if (phase >= 0) g_profiler.record(phase, start, Profiler::nowNs());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    int phase;
+    std::uint64_t start;
+};
+
+// -------------------- Instrumentation Macro --------------------
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef DRS_NO_PROFILER
+#define PROFILE_SCOPE(name) ((void)0)
+#else
+#define PROFILE_SCOPE(name) \
+    static const int PROFILE_CONCAT(profilePhase, __LINE__) = g_profiler.phaseId(name); \
+    ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(PROFILE_CONCAT(profilePhase, __LINE__))
+#endif
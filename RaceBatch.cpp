@@ -0,0 +1,207 @@
+// RaceBatch.cpp : Monte Carlo race batches with streaming statistics.
+// Part of the GL-free simulation core.
+
+#include "RaceBatch.h"
+#include "CounterRng.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <cmath>
+
+// -------------------- Default Grid --------------------
+// Same cars and parameter ranges as the GLUT demo in main.cpp
+std::vector<CarConfig> defaultCarConfigs() {
+    return {
+        { "BMW",      1.0f, 0.0f, 0.0f, 4.8f, 0.5f, 1.0f, 1.0f, 1.8f, 0.5f },
+        { "Mercedes", 0.0f, 1.0f, 0.0f, 4.8f, 0.5f, 1.0f, 1.0f, 1.8f, 0.5f },
+        { "Ford",     0.0f, 0.0f, 1.0f, 4.8f, 0.5f, 1.0f, 1.0f, 1.8f, 0.5f },
+    };
+}
+
+// -------------------- Running Statistics --------------------
+void RunningStats::add(double x) {
+    if (count == 0) min = max = x;
+    min = std::min(min, x);
+    max = std::max(max, x);
+    ++count;
+    double delta = x - mean;
+    mean += delta / count;
+    m2 += delta * (x - mean);
+}
+
+// Chan et al. parallel combination of two Welford accumulators
+void RunningStats::merge(const RunningStats& other) {
+    if (other.count == 0) return;
+    if (count == 0) { *this = other; return; }
+    long long total = count + other.count;
+    double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * (static_cast<double>(count) * other.count / total);
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    count = total;
+}
+
+double RunningStats::stddev() const {
+    return count > 1 ? std::sqrt(m2 / (count - 1)) : 0.0;
+}
+
+// -------------------- Histogram --------------------
+Histogram::Histogram(double lo, double hi, int binCount)
+    : lo(lo), hi(hi), bins(binCount, 0)
+{
+}
+
+void Histogram::add(double x) {
+    if (x < lo) { ++below; return; }
+    if (x >= hi) { ++above; return; }
+    int bin = static_cast<int>((x - lo) / (hi - lo) * bins.size());
+    ++bins[std::min(bin, static_cast<int>(bins.size()) - 1)];
+}
+
+void Histogram::merge(const Histogram& other) {
+    below += other.below;
+    above += other.above;
+    for (size_t i = 0; i < bins.size() && i < other.bins.size(); ++i)
+        bins[i] += other.bins[i];
+}
+
+double Histogram::quantile(double q) const {
+    long long total = below + above;
+    for (long long c : bins) total += c;
+    if (total == 0) return 0.0;
+
+    long long rank = static_cast<long long>(std::ceil(q * total));
+    long long seen = below;
+    if (rank <= seen) return lo;
+    double width = (hi - lo) / bins.size();
+    for (size_t i = 0; i < bins.size(); ++i) {
+        seen += bins[i];
+        if (rank <= seen) return lo + (i + 0.5) * width;
+    }
+    return hi;
+}
+
+// -------------------- Constructor --------------------
+RaceBatch::RaceBatch()
+    : configs(defaultCarConfigs()), laps(3), dt(0.016f), maxRaceTime(600.0f), seed(1), events(nullptr)
+{
+}
+
+// -------------------- Single Race --------------------
+// Builds the grid from the race's own RNG stream and steps until every car has
+// completed the requested laps (or the time limit is hit)
+RaceResult RaceBatch::runRace(long long raceIndex) const {
+    CounterRng rng(seed, static_cast<std::uint64_t>(raceIndex));
+    int n = static_cast<int>(configs.size());
+
+    Simulation sim;
+    sim.setTrack(track);
+    int laneCount = sim.track.laneCount();
+    for (int c = 0; c < n; ++c) {
+        const CarConfig& cfg = configs[c];
+        Car& car = sim.addCar(c % laneCount, c / laneCount, cfg.r, cfg.g, cfg.b, cfg.name);
+        car.maxSpeed = rng.uniform(cfg.maxSpeedMin, cfg.maxSpeedRange);
+        car.speed = rng.uniform(cfg.startSpeedMin, cfg.startSpeedRange);
+        car.accelerationFactor = rng.uniform(cfg.accelMin, cfg.accelRange);
+    }
+    if (events) {
+        // Each pool thread emits into its own ring of the shared stream
+        sim.events = events;
+        sim.raceId = static_cast<int>(raceIndex);
+        sim.updateStandings(); // Baseline: the grid itself is not an event
+    }
+
+    RaceResult result;
+    result.finishTime.assign(n, -1.0f);
+    result.lapTimes.assign(n, std::vector<float>());
+
+    std::vector<int> lapsSeen(n);
+    std::vector<float> lapStart(n, 0.0f);
+    for (int c = 0; c < n; ++c) lapsSeen[c] = sim.cars[c].lap;
+
+    int finishedCount = 0;
+    float time = 0.0f;
+    while (finishedCount < n && time < maxRaceTime) {
+        sim.step(dt);
+        time += dt;
+
+        // Record every lap line crossing since the last step
+        for (int c = 0; c < n; ++c) {
+            while (lapsSeen[c] < sim.cars[c].lap) {
+                ++lapsSeen[c];
+                if (lapsSeen[c] <= 0) { lapStart[c] = time; continue; } // Reached the start line
+                if (result.finishTime[c] >= 0.0f) continue;
+                result.lapTimes[c].push_back(time - lapStart[c]);
+                lapStart[c] = time;
+                if (lapsSeen[c] == laps) {
+                    result.finishTime[c] = time;
+                    ++finishedCount;
+                }
+            }
+        }
+    }
+
+    // Winner: earliest finisher; if nobody finished, the car with the most progress
+    float best = -1.0f;
+    for (int c = 0; c < n; ++c) {
+        float t = result.finishTime[c];
+        if (t >= 0.0f && (result.winner < 0 || t < best)) { result.winner = c; best = t; }
+    }
+    if (result.winner < 0) {
+        float bestProgress = -1.0f;
+        for (int c = 0; c < n; ++c) {
+            const Car& car = sim.cars[c];
+            float progress = car.raceProgress();
+            if (progress > bestProgress) { bestProgress = progress; result.winner = c; }
+        }
+    }
+    return result;
+}
+
+// -------------------- Accumulators --------------------
+std::vector<ConfigStats> RaceBatch::makeStats() const {
+    std::vector<ConfigStats> stats(configs.size());
+    for (auto& s : stats)
+        s.lapHistogram = Histogram(0.0, 60.0, 6000); // 10 ms bins up to one minute
+    return stats;
+}
+
+void RaceBatch::accumulate(const RaceResult& race, std::vector<ConfigStats>& stats) const {
+    if (race.winner >= 0) ++stats[race.winner].wins;
+    for (size_t c = 0; c < stats.size(); ++c) {
+        for (float lap : race.lapTimes[c]) {
+            stats[c].lapTime.add(lap);
+            stats[c].lapHistogram.add(lap);
+        }
+        if (race.finishTime[c] >= 0.0f) {
+            ++stats[c].finishes;
+            stats[c].raceTime.add(race.finishTime[c]);
+        }
+    }
+}
+
+// -------------------- Batch --------------------
+// Each pool participant folds its races into private accumulators; these are
+// merged in participant order once all races are done
+std::vector<ConfigStats> RaceBatch::run(long long raceCount, ThreadPool& pool) const {
+    std::vector<std::vector<ConfigStats>> perThread(pool.threadCount());
+    for (auto& stats : perThread)
+        stats = makeStats();
+
+    int tasks = static_cast<int>(std::min<long long>(raceCount, 0x7fffffff));
+    pool.runTasks(tasks, [this, &perThread](int race, int participant) {
+        accumulate(runRace(race), perThread[participant]);
+    });
+
+    std::vector<ConfigStats> total = makeStats();
+    for (const auto& stats : perThread) {
+        for (size_t c = 0; c < total.size(); ++c) {
+            total[c].wins += stats[c].wins;
+            total[c].finishes += stats[c].finishes;
+            total[c].lapTime.merge(stats[c].lapTime);
+            total[c].lapHistogram.merge(stats[c].lapHistogram);
+            total[c].raceTime.merge(stats[c].raceTime);
+        }
+    }
+    return total;
+}
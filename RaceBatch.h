@@ -0,0 +1,104 @@
+#pragma once
+#include "ThreadPool.h"
+#include "Track.h"
+#include "RaceEvents.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// -------------------- Car Configuration --------------------
+// One grid slot in a Monte Carlo batch. Each race samples the car's parameters
+// uniformly from [min, min + range), like main() does for the GLUT demo.
+struct CarConfig {
+    std::string name;            // Display name
+    float r, g, b;               // Body color (0-1)
+    float maxSpeedMin, maxSpeedRange;
+    float startSpeedMin, startSpeedRange;
+    float accelMin, accelRange;
+};
+
+// The three-car field of the GLUT demo (BMW, Mercedes, Ford) with main()'s ranges
+std::vector<CarConfig> defaultCarConfigs();
+
+// -------------------- Running Statistics --------------------
+// Streaming count/mean/variance/min/max (Welford), mergeable across threads
+struct RunningStats {
+    long long count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;             // Sum of squared deviations from the mean
+    double min = 0.0;
+    double max = 0.0;
+
+    void add(double x);
+    void merge(const RunningStats& other);
+    double stddev() const;
+};
+
+// -------------------- Histogram --------------------
+// Fixed-width bins over [lo, hi) for streaming quantile estimates
+struct Histogram {
+    double lo = 0.0;
+    double hi = 0.0;
+    std::vector<long long> bins;
+    long long below = 0;         // Samples under lo
+    long long above = 0;         // Samples at or over hi
+
+    Histogram() {}
+    Histogram(double lo, double hi, int binCount);
+
+    void add(double x);
+    void merge(const Histogram& other);
+
+    // Value below which a fraction q of the samples fall (bin midpoint)
+    double quantile(double q) const;
+};
+
+// -------------------- Per-Configuration Results --------------------
+struct ConfigStats {
+    long long wins = 0;          // Races this configuration won
+    long long finishes = 0;      // Races in which it completed every lap
+    RunningStats lapTime;        // Seconds per completed lap
+    Histogram lapHistogram;      // Lap time distribution
+    RunningStats raceTime;       // Seconds to complete all laps
+};
+
+// -------------------- Single Race Result --------------------
+struct RaceResult {
+    int winner = -1;                          // Config index of the winner
+    std::vector<float> finishTime;            // Per config, negative if not finished
+    std::vector<std::vector<float>> lapTimes; // Per config, seconds per completed lap
+};
+
+// -------------------- RaceBatch Class --------------------
+// Runs many independent races and reduces their results into streaming
+// per-configuration statistics. Races are spread across a ThreadPool with
+// work stealing; every race draws from its own CounterRng stream keyed by
+// (seed, race index), so any race can be re-run on its own with runRace().
+class RaceBatch {
+public:
+    std::vector<CarConfig> configs;  // Grid, one car per configuration
+    int laps;                        // Laps to complete
+    float dt;                        // Simulation time step
+    float maxRaceTime;               // Give up on a race after this many seconds
+    Track track;                     // Track of every race (its geometry is shared by all races)
+    std::uint64_t seed;              // Batch seed
+    EventStream* events;             // Race events of every race, tagged with the race index (nullptr = none)
+
+    // -------------------- Constructor --------------------
+    RaceBatch();
+
+    // -------------------- Single Race --------------------
+    // Simulates race 'raceIndex' of the batch; deterministic for a given seed
+    RaceResult runRace(long long raceIndex) const;
+
+    // -------------------- Batch --------------------
+    // Runs races [0, raceCount) on the pool and returns one entry per configuration
+    std::vector<ConfigStats> run(long long raceCount, ThreadPool& pool) const;
+
+private:
+    // Empty accumulators for every configuration
+    std::vector<ConfigStats> makeStats() const;
+
+    // Folds one race result into the accumulators
+    void accumulate(const RaceResult& race, std::vector<ConfigStats>& stats) const;
+};
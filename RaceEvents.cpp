@@ -0,0 +1,142 @@
+// RaceEvents.cpp : race event stream with per-thread lock-free rings.
+// Part of the GL-free simulation core.
+
+#include "RaceEvents.h"
+#include <chrono>
+
+// -------------------- Event Names --------------------
+const char* raceEventName(RaceEventType type) {
+    switch (type) {
+    case RaceEventType::Lap: return "lap";
+    case RaceEventType::LaneChange: return "lane";
+    default: return "overtake";
+    }
+}
+
+// Source of EventStream::streamId; never reused, so a cached ring of a
+// destroyed stream cannot be mistaken for one of a new stream
+static std::atomic<std::uint64_t> nextStreamId(1);
+
+// -------------------- Constructor / Destructor --------------------
+EventStream::EventStream(int ringCapacity)
+    : ringCapacity(ringCapacity), streamId(nextStreamId.fetch_add(1)), log(nullptr), logFailed(false),
+    stopping(false), deliveredCount(0)
+{
+}
+
+EventStream::~EventStream() {
+    stop();
+}
+
+// -------------------- Setup --------------------
+bool EventStream::openLog(const std::string& path) {
+    log = fopen(path.c_str(), "w");
+    if (!log) {
+        printf("Error: cannot create event log %s\n", path.c_str());
+        return false;
+    }
+    setvbuf(log, nullptr, _IOFBF, 1 << 20);
+    return true;
+}
+
+void EventStream::subscribe(std::function<void(const RaceEvent&)> subscriber) {
+    subscribers.push_back(std::move(subscriber));
+}
+
+// -------------------- Consumer --------------------
+void EventStream::start() {
+    if (running()) return;
+    stopping.store(false);
+    consumer = std::thread([this]() { consumerLoop(); });
+}
+
+bool EventStream::stop() {
+    if (running()) {
+        stopping.store(true);
+        consumer.join();
+    }
+    bool ok = !logFailed;
+    if (log) {
+        if (ferror(log) || fclose(log) != 0) ok = false;
+        log = nullptr;
+    }
+    return ok;
+}
+
+// Polls with a short sleep when idle; after 'stopping' is seen, one more
+// drain picks up everything emitted before stop() was called
+void EventStream::consumerLoop() {
+    while (!stopping.load()) {
+        if (!drain()) std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    while (drain()) {}
+    if (log) fflush(log);
+}
+
+int EventStream::drain() {
+    // Rings are never removed, so the pointers stay valid outside the lock
+    std::vector<ProducerRing*> current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& producer : rings) current.push_back(producer.get());
+    }
+
+    int count = 0;
+    RaceEvent event;
+    for (ProducerRing* producer : current) {
+        while (producer->ring.tryPop(event)) {
+            if (log && fprintf(log, "%lld %d %s %d %d %d\n", static_cast<long long>(event.tick), event.race,
+                    raceEventName(event.type), event.car, event.a, event.b) < 0)
+                logFailed = true;
+            for (const auto& subscriber : subscribers) subscriber(event);
+            ++count;
+        }
+    }
+    deliveredCount.fetch_add(count, std::memory_order_relaxed);
+    return count;
+}
+
+// -------------------- Producer --------------------
+// The calling thread's ring, created on its first event. The lock is taken
+// only then; later calls hit the thread-local cache.
+EventStream::ProducerRing& EventStream::producerRing() {
+    thread_local std::uint64_t ownerStream = 0;
+    thread_local ProducerRing* cached = nullptr;
+    if (ownerStream == streamId) return *cached;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ProducerRing* found = nullptr;
+    for (const auto& producer : rings)
+        if (producer->owner == std::this_thread::get_id()) found = producer.get();
+    if (!found) {
+        rings.emplace_back(new ProducerRing(ringCapacity));
+        found = rings.back().get();
+        found->owner = std::this_thread::get_id();
+    }
+    ownerStream = streamId;
+    cached = found;
+    return *found;
+}
+
+void EventStream::emit(const RaceEvent& event) {
+    ProducerRing& producer = producerRing();
+    if (producer.ring.tryPush(event))
+        producer.emitted.store(producer.emitted.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    else
+        producer.dropped.store(producer.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// -------------------- Statistics --------------------
+long long EventStream::emitted() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    long long total = 0;
+    for (const auto& producer : rings) total += producer->emitted.load(std::memory_order_relaxed);
+    return total;
+}
+
+long long EventStream::dropped() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    long long total = 0;
+    for (const auto& producer : rings) total += producer->dropped.load(std::memory_order_relaxed);
+    return total;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "SpscRing.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -------------------- Race Events --------------------
+// Something that happened to a car during one simulation step
+enum class RaceEventType : std::uint8_t {
+    Lap,         // Car crossed the start/finish line: a = new lap number
+    LaneChange,  // Car moved to another lane: a = old lane, b = new lane
+    Overtake     // Car passed another car: a = car passed, b = new 0-based position
+};
+
+struct RaceEvent {
+    std::int64_t tick;       // Simulation::stepCount when the event was published
+    std::int32_t race;       // Simulation::raceId (several races may share a stream)
+    std::int32_t car;        // Car index the event is about
+    std::int32_t a, b;       // Type-specific values (see RaceEventType)
+    RaceEventType type;
+};
+
+// Name of an event type in the log ("lap", "lane", "overtake")
+const char* raceEventName(RaceEventType type);
+
+// -------------------- EventStream Class --------------------
+// Carries race events from simulation threads to a background consumer that
+// writes them to a log file and hands them to in-process subscribers.
+//
+// Every producing thread gets its own SpscRing on its first emit(), so
+// producers never share a queue or take a lock after that. emit() never
+// waits: when a thread's ring is full the event is counted as dropped, so
+// the simulation cannot be slowed down by the log file or a slow subscriber.
+// The consumer thread polls all rings, writes and delivers what it finds, and
+// sleeps briefly when every ring is empty. Events of one thread are delivered
+// in the order they were emitted.
+//
+// Log format: one line per event, "tick race type car a b".
+class EventStream {
+public:
+    static const int kDefaultRingCapacity = 1 << 16; // Events buffered per producing thread
+
+    // -------------------- Constructor / Destructor --------------------
+    explicit EventStream(int ringCapacity = kDefaultRingCapacity);
+    ~EventStream();   // Stops the consumer (delivering what is queued)
+
+    EventStream(const EventStream&) = delete;
+    EventStream& operator=(const EventStream&) = delete;
+
+    // -------------------- Setup --------------------
+    // Call before start(). Returns false if the log file cannot be created.
+    bool openLog(const std::string& path);
+
+    // Adds a callback run on the consumer thread for every event; call before start()
+    void subscribe(std::function<void(const RaceEvent&)> subscriber);
+
+    // -------------------- Consumer --------------------
+    // Starts the background consumer thread
+    void start();
+
+    // Delivers every queued event, stops the consumer and closes the log.
+    // Returns false if writing the log failed.
+    bool stop();
+
+    bool running() const { return consumer.joinable(); }
+
+    // -------------------- Producer --------------------
+    // Queues an event from the calling thread without blocking
+    void emit(const RaceEvent& event);
+
+    // -------------------- Statistics --------------------
+    long long emitted() const;     // Events accepted by emit()
+    long long dropped() const;     // Events lost to full rings
+    long long delivered() const { return deliveredCount.load(std::memory_order_relaxed); }
+
+private:
+    // One producer thread's queue and counters (written only by that thread)
+    struct ProducerRing {
+        explicit ProducerRing(int capacity) : ring(capacity), emitted(0), dropped(0) {}
+        SpscRing<RaceEvent> ring;
+        std::atomic<long long> emitted;
+        std::atomic<long long> dropped;
+        std::thread::id owner;
+    };
+
+    int ringCapacity;
+    std::uint64_t streamId;                  // Tells streams apart in the thread-local ring cache
+    mutable std::mutex mutex;                // Guards 'rings' (the list, not the queues)
+    std::vector<std::unique_ptr<ProducerRing>> rings;
+    std::vector<std::function<void(const RaceEvent&)>> subscribers;
+    FILE* log;
+    bool logFailed;
+
+    std::thread consumer;
+    std::atomic<bool> stopping;
+    std::atomic<long long> deliveredCount;
+
+    // The calling thread's ring, created on its first event
+    ProducerRing& producerRing();
+
+    // Consumer thread main loop
+    void consumerLoop();
+
+    // Drains every ring once; returns the number of events delivered
+    int drain();
+};
@@ -0,0 +1,464 @@
+// Replay.cpp : compact replay recording and seekable playback.
+// Part of the GL-free simulation core.
+
+#include "Replay.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// -------------------- File Layout --------------------
+//   ReplayHeader
+//   track path (header.trackPathLength bytes)
+//   per car: varint name length, name, colorR, colorG, colorB (one byte each)
+//   frames: per tick, per car: field mask byte, zigzag varint per set bit
+//   keyframe offsets (uint64 per keyframe, from the start of the file)
+//   ReplayFooter
+static const char kReplayMagic[8] = { 'D', 'R', 'S', 'R', 'E', 'P', 'L', 'Y' };
+static const char kReplayEndMagic[8] = { 'D', 'R', 'S', 'R', 'E', 'N', 'D', '!' };
+static const std::uint32_t kReplayVersion = 1;   // Bump when the layout or quantisation changes
+static const std::uint32_t kReplayEndianTag = 0x01020304;
+
+struct ReplayHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endianTag;
+    std::uint32_t carCount;
+    std::uint32_t keyframeInterval;
+    float tickSeconds;
+    std::uint32_t trackPathLength;
+};
+
+struct ReplayFooter {
+    std::uint64_t indexOffset;     // End of the frames, start of the keyframe offsets
+    std::uint32_t tickCount;
+    std::uint32_t keyframeCount;
+    char magic[8];
+};
+
+// -------------------- Quantisation --------------------
+// Field order inside a car record (bit i of the mask = field i is stored)
+enum ReplayField { kFieldX, kFieldY, kFieldRotation, kFieldWheel, kFieldSpeed, kFieldProgress, kFieldLane, kFieldLap, kFieldCount };
+
+static const double kPositionScale = 1024.0;  // Steps per world unit
+static const double kAngleScale = 64.0;       // Steps per degree
+static const double kSpeedScale = 256.0;      // Steps per speed unit
+static const double kProgressScale = 65536.0; // Steps per lap
+static const std::int64_t kRotationModulus = 360 * 64;
+static const std::int64_t kProgressModulus = 65536;
+
+// Fields that wrap around (0 = no wrap)
+static std::int64_t fieldModulus(int field) {
+    if (field == kFieldRotation) return kRotationModulus;
+    if (field == kFieldProgress) return kProgressModulus;
+    return 0;
+}
+
+static std::int64_t wrapPositive(std::int64_t value, std::int64_t modulus) {
+    value %= modulus;
+    return value < 0 ? value + modulus : value;
+}
+
+static void quantise(const Car& car, std::int64_t* q) {
+    q[kFieldX] = std::llround(car.position.x * kPositionScale);
+    q[kFieldY] = std::llround(car.position.y * kPositionScale);
+    q[kFieldRotation] = wrapPositive(std::llround(car.rotation * kAngleScale), kRotationModulus);
+    q[kFieldWheel] = std::llround(car.wheelRotation * kAngleScale);
+    q[kFieldSpeed] = std::llround(car.speed * kSpeedScale);
+    q[kFieldProgress] = wrapPositive(std::llround(car.lapProgress * kProgressScale), kProgressModulus);
+    q[kFieldLane] = car.laneIndex * 2 + (car.finished ? 1 : 0);
+    q[kFieldLap] = car.lap;
+}
+
+static void dequantise(const std::int64_t* q, ReplayCarState& state) {
+    state.position = Vector2(static_cast<float>(q[kFieldX] / kPositionScale), static_cast<float>(q[kFieldY] / kPositionScale));
+    state.rotation = static_cast<float>(q[kFieldRotation] / kAngleScale);
+    state.wheelRotation = static_cast<float>(q[kFieldWheel] / kAngleScale);
+    state.speed = static_cast<float>(q[kFieldSpeed] / kSpeedScale);
+    state.lapProgress = static_cast<float>(q[kFieldProgress] / kProgressScale);
+    state.lane = static_cast<int>(q[kFieldLane] >> 1);
+    state.finished = (q[kFieldLane] & 1) != 0;
+    state.lap = static_cast<int>(q[kFieldLap]);
+}
+
+// -------------------- Prediction --------------------
+// 'last' and 'beforeLast' are the car's fields in the two previous ticks
+// (all zero right after a keyframe). Motion fields continue their last
+// change; lane and lap are expected to stay.
+static std::int64_t predict(int field, const std::int64_t* last, const std::int64_t* beforeLast) {
+    if (field == kFieldLane || field == kFieldLap) return last[field];
+    return 2 * last[field] - beforeLast[field];
+}
+
+// -------------------- Varints --------------------
+static void putVarint(std::vector<unsigned char>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+static bool getVarint(const unsigned char*& p, const unsigned char* end, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        unsigned char byte = *p++;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Small negative and positive residuals both become small unsigned values
+static std::uint64_t zigzag(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+static std::int64_t unzigzag(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+// ==================== Tick Codec ====================
+
+// -------------------- Encoder --------------------
+void ReplayTickEncoder::reset(int carCount) {
+    history.assign(static_cast<size_t>(carCount) * 2 * kFieldCount, 0);
+}
+
+void ReplayTickEncoder::keyframe() {
+    std::fill(history.begin(), history.end(), 0);
+}
+
+void ReplayTickEncoder::encode(const std::vector<Car>& cars, std::vector<unsigned char>& out) {
+    std::int64_t q[kFieldCount];
+    std::int64_t residual[kFieldCount];
+    size_t carCount = history.size() / (2 * kFieldCount);
+    for (size_t i = 0; i < carCount; ++i) {
+        std::int64_t* last = &history[i * 2 * kFieldCount];
+        std::int64_t* beforeLast = last + kFieldCount;
+        quantise(cars[i], q);
+
+        unsigned char mask = 0;
+        for (int f = 0; f < kFieldCount; ++f) {
+            std::int64_t r = q[f] - predict(f, last, beforeLast);
+            std::int64_t modulus = fieldModulus(f);
+            if (modulus) {
+                // Shortest way around, in [-modulus / 2, modulus / 2)
+                r = wrapPositive(r + modulus / 2, modulus) - modulus / 2;
+            }
+            residual[f] = r;
+            if (r != 0) mask |= static_cast<unsigned char>(1 << f);
+        }
+
+        out.push_back(mask);
+        for (int f = 0; f < kFieldCount; ++f)
+            if (mask & (1 << f)) putVarint(out, zigzag(residual[f]));
+
+        memcpy(beforeLast, last, sizeof(std::int64_t) * kFieldCount);
+        memcpy(last, q, sizeof(q));
+    }
+}
+
+// -------------------- Decoder --------------------
+void ReplayTickDecoder::reset(int carCount) {
+    history.assign(static_cast<size_t>(carCount) * 2 * kFieldCount, 0);
+}
+
+void ReplayTickDecoder::keyframe() {
+    std::fill(history.begin(), history.end(), 0);
+}
+
+bool ReplayTickDecoder::decode(const unsigned char*& cursor, const unsigned char* end, std::vector<ReplayCarState>& states) {
+    const unsigned char* p = cursor;
+    std::int64_t q[kFieldCount];
+    for (size_t i = 0; i < states.size(); ++i) {
+        std::int64_t* last = &history[i * 2 * kFieldCount];
+        std::int64_t* beforeLast = last + kFieldCount;
+        if (p >= end) return false;
+        unsigned char mask = *p++;
+
+        for (int f = 0; f < kFieldCount; ++f) {
+            std::int64_t residual = 0;
+            if (mask & (1 << f)) {
+                std::uint64_t raw;
+                if (!getVarint(p, end, raw)) return false;
+                residual = unzigzag(raw);
+            }
+            q[f] = predict(f, last, beforeLast) + residual;
+            std::int64_t modulus = fieldModulus(f);
+            if (modulus) q[f] = wrapPositive(q[f], modulus);
+        }
+
+        memcpy(beforeLast, last, sizeof(std::int64_t) * kFieldCount);
+        memcpy(last, q, sizeof(q));
+        dequantise(q, states[i]);
+    }
+    cursor = p;
+    return true;
+}
+
+// -------------------- Car Table --------------------
+void encodeReplayCars(const Simulation& sim, std::vector<unsigned char>& out) {
+    for (size_t i = 0; i < sim.cars.size(); ++i) {
+        const std::string& name = i < sim.carNames.size() ? sim.carNames[i] : std::string();
+        const Car& car = sim.cars[i];
+        putVarint(out, name.size());
+        out.insert(out.end(), name.begin(), name.end());
+        out.push_back(static_cast<unsigned char>(car.colorR));
+        out.push_back(static_cast<unsigned char>(car.colorG));
+        out.push_back(static_cast<unsigned char>(car.colorB));
+    }
+}
+
+bool decodeReplayCars(const unsigned char*& p, const unsigned char* end, std::uint32_t count,
+    std::vector<ReplayCarInfo>& cars) {
+    cars.clear();
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::uint64_t nameLength;
+        if (!getVarint(p, end, nameLength) || nameLength + 3 > static_cast<std::uint64_t>(end - p)) return false;
+        ReplayCarInfo info;
+        info.name.assign(reinterpret_cast<const char*>(p), static_cast<size_t>(nameLength));
+        p += nameLength;
+        info.colorR = p[0];
+        info.colorG = p[1];
+        info.colorB = p[2];
+        p += 3;
+        cars.push_back(info);
+    }
+    return true;
+}
+
+// -------------------- Setup --------------------
+bool setupReplayCars(Simulation& sim, const std::string& trackPath, const std::vector<ReplayCarInfo>& cars,
+    const std::vector<ReplayCarState>& states) {
+    if (!sim.cars.empty()) return false;
+    if (!trackPath.empty() && !sim.loadTrack(trackPath)) return false;
+    for (size_t i = 0; i < cars.size(); ++i) {
+        int lane = i < states.size() ? states[i].lane : 0;
+        if (lane < 0 || lane >= sim.track.laneCount()) {
+            printf("Error: replay uses lane %d, the track has %d\n", lane, sim.track.laneCount());
+            return false;
+        }
+        const ReplayCarInfo& info = cars[i];
+        sim.addCar(lane, 0, info.colorR / 255.0f, info.colorG / 255.0f, info.colorB / 255.0f, info.name);
+    }
+    applyReplayStates(states, sim.cars);
+    return true;
+}
+
+void applyReplayStates(const std::vector<ReplayCarState>& states, std::vector<Car>& target) {
+    size_t n = std::min(target.size(), states.size());
+    for (size_t i = 0; i < n; ++i) {
+        const ReplayCarState& state = states[i];
+        Car& car = target[i];
+        car.position = state.position;
+        car.rotation = state.rotation;
+        car.wheelRotation = state.wheelRotation;
+        car.speed = state.speed;
+        car.lapProgress = state.lapProgress;
+        car.laneIndex = state.lane;
+        car.targetLaneIndex = state.lane;
+        car.lap = state.lap;
+        car.finished = state.finished;
+    }
+}
+
+// ==================== ReplayWriter ====================
+
+// -------------------- Constructor --------------------
+ReplayWriter::ReplayWriter()
+    : file(nullptr), carCount(0), keyframeInterval(kDefaultKeyframeInterval),
+    tickCount(0), bytesWritten(0), failed(false)
+{
+}
+
+ReplayWriter::~ReplayWriter() {
+    close();
+}
+
+// -------------------- Recording --------------------
+bool ReplayWriter::open(const std::string& replayPath, const Simulation& sim, const std::string& trackPath,
+    float tickSeconds, int interval) {
+    close();
+    file = fopen(replayPath.c_str(), "wb");
+    if (!file) {
+        printf("Error: could not create replay %s\n", replayPath.c_str());
+        return false;
+    }
+    path = replayPath;
+    carCount = static_cast<int>(sim.cars.size());
+    keyframeInterval = interval > 0 ? interval : kDefaultKeyframeInterval;
+    tickCount = 0;
+    bytesWritten = 0;
+    failed = false;
+    keyframeOffsets.clear();
+    encoder.reset(carCount);
+    buffer.clear();
+
+    ReplayHeader header = {};
+    memcpy(header.magic, kReplayMagic, sizeof(header.magic));
+    header.version = kReplayVersion;
+    header.endianTag = kReplayEndianTag;
+    header.carCount = static_cast<std::uint32_t>(carCount);
+    header.keyframeInterval = static_cast<std::uint32_t>(keyframeInterval);
+    header.tickSeconds = tickSeconds;
+    header.trackPathLength = static_cast<std::uint32_t>(trackPath.size());
+
+    const unsigned char* raw = reinterpret_cast<const unsigned char*>(&header);
+    buffer.insert(buffer.end(), raw, raw + sizeof(header));
+    buffer.insert(buffer.end(), trackPath.begin(), trackPath.end());
+    encodeReplayCars(sim, buffer);
+    return true;
+}
+
+void ReplayWriter::record(const std::vector<Car>& cars) {
+    if (!file || failed) return;
+    if (static_cast<int>(cars.size()) != carCount) {
+        printf("Error: replay %s expects %d cars, got %d\n", path.c_str(), carCount, static_cast<int>(cars.size()));
+        failed = true;
+        return;
+    }
+
+    // Keyframe: restart the prediction so this tick decodes on its own
+    if (tickCount % keyframeInterval == 0) {
+        keyframeOffsets.push_back(static_cast<std::uint64_t>(bytesWritten) + buffer.size());
+        encoder.keyframe();
+    }
+    encoder.encode(cars, buffer);
+    ++tickCount;
+    if (buffer.size() >= 64 * 1024) flush();
+}
+
+void ReplayWriter::flush() {
+    if (!buffer.empty() && fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) failed = true;
+    bytesWritten += static_cast<long long>(buffer.size());
+    buffer.clear();
+}
+
+bool ReplayWriter::close() {
+    if (!file) return !failed;
+
+    ReplayFooter footer = {};
+    footer.indexOffset = static_cast<std::uint64_t>(bytesWritten) + buffer.size();
+    footer.tickCount = static_cast<std::uint32_t>(tickCount);
+    footer.keyframeCount = static_cast<std::uint32_t>(keyframeOffsets.size());
+    memcpy(footer.magic, kReplayEndMagic, sizeof(footer.magic));
+
+    const unsigned char* raw = reinterpret_cast<const unsigned char*>(keyframeOffsets.data());
+    buffer.insert(buffer.end(), raw, raw + keyframeOffsets.size() * sizeof(std::uint64_t));
+    raw = reinterpret_cast<const unsigned char*>(&footer);
+    buffer.insert(buffer.end(), raw, raw + sizeof(footer));
+    flush();
+
+    if (fclose(file) != 0) failed = true;
+    file = nullptr;
+    if (failed) printf("Error: could not write replay %s\n", path.c_str());
+    return !failed;
+}
+
+// ==================== ReplayReader ====================
+
+// -------------------- Constructor --------------------
+ReplayReader::ReplayReader()
+    : tickSeconds(0.0f), keyframeInterval(0), frames(nullptr), framesEnd(nullptr),
+    ticks(0), current(-1), cursor(nullptr)
+{
+}
+
+// -------------------- Loading --------------------
+bool ReplayReader::open(const std::string& path) {
+    ticks = 0;
+    current = -1;
+    cars.clear();
+    if (!file.open(path)) {
+        printf("Error: could not open replay %s\n", path.c_str());
+        return false;
+    }
+
+    const unsigned char* data = file.data();
+    size_t size = file.size();
+    ReplayHeader header;
+    ReplayFooter footer;
+    bool ok = size >= sizeof(header) + sizeof(footer);
+    if (ok) {
+        memcpy(&header, data, sizeof(header));
+        memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+        ok = memcmp(header.magic, kReplayMagic, sizeof(header.magic)) == 0 &&
+             header.version == kReplayVersion && header.endianTag == kReplayEndianTag &&
+             header.keyframeInterval > 0 &&
+             memcmp(footer.magic, kReplayEndMagic, sizeof(footer.magic)) == 0 &&
+             footer.keyframeCount == (footer.tickCount + header.keyframeInterval - 1) / header.keyframeInterval &&
+             footer.indexOffset <= size &&
+             size - footer.indexOffset == footer.keyframeCount * sizeof(std::uint64_t) + sizeof(footer) &&
+             sizeof(header) + header.trackPathLength <= footer.indexOffset;
+    }
+    if (!ok) {
+        printf("Error: %s is not a complete replay (version %u expected)\n", path.c_str(), kReplayVersion);
+        file.close();
+        return false;
+    }
+
+    tickSeconds = header.tickSeconds;
+    keyframeInterval = static_cast<int>(header.keyframeInterval);
+    ticks = static_cast<int>(footer.tickCount);
+    framesEnd = data + footer.indexOffset;
+    keyframeOffsets.resize(footer.keyframeCount);
+    memcpy(keyframeOffsets.data(), framesEnd, footer.keyframeCount * sizeof(std::uint64_t));
+
+    const unsigned char* p = data + sizeof(header);
+    trackPath.assign(reinterpret_cast<const char*>(p), header.trackPathLength);
+    p += header.trackPathLength;
+    ok = decodeReplayCars(p, framesEnd, header.carCount, cars);
+    for (std::uint64_t offset : keyframeOffsets)
+        ok = ok && offset >= static_cast<std::uint64_t>(p - data) && offset <= footer.indexOffset;
+    if (!ok) {
+        printf("Error: replay %s is corrupt\n", path.c_str());
+        file.close();
+        ticks = 0;
+        return false;
+    }
+
+    frames = p;
+    cursor = frames;
+    decoder.reset(static_cast<int>(cars.size()));
+    carStates.assign(cars.size(), ReplayCarState());
+    return ticks == 0 || seek(0);
+}
+
+// Adds the recorded cars on their tick-0 lanes and moves them to tick 0
+bool ReplayReader::setup(Simulation& sim) const {
+    return setupReplayCars(sim, trackPath, cars, ticks > 0 ? carStates : std::vector<ReplayCarState>());
+}
+
+// -------------------- Playback --------------------
+bool ReplayReader::seek(int tick) {
+    if (ticks == 0) return false;
+    if (tick < 0) tick = 0;
+    if (tick >= ticks) tick = ticks - 1;
+
+    // Decode forward from the current tick when that is no longer than from the keyframe
+    int keyframe = tick / keyframeInterval;
+    if (tick < current || current < keyframe * keyframeInterval - 1) {
+        cursor = file.data() + keyframeOffsets[keyframe];
+        current = keyframe * keyframeInterval - 1;
+    }
+    while (current < tick)
+        if (!decodeTick()) return false;
+    return true;
+}
+
+bool ReplayReader::next() {
+    if (current + 1 >= ticks) return false;
+    return decodeTick();
+}
+
+bool ReplayReader::decodeTick() {
+    int tick = current + 1;
+    if (tick % keyframeInterval == 0) decoder.keyframe();
+    if (!decoder.decode(cursor, framesEnd, carStates)) return false;
+    current = tick;
+    return true;
+}
+
+void ReplayReader::apply(std::vector<Car>& target) const {
+    applyReplayStates(carStates, target);
+}
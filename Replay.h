@@ -0,0 +1,188 @@
+#pragma once
+#include "Simulation.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// -------------------- Replay Format --------------------
+// A replay stores the state of every car after every tick:
+//   header, track path, car names and colors
+//   frames (tick 0 = starting grid, tick i = state after i steps)
+//   keyframe index (byte offset of every keyframe), footer
+//
+// Each car's fields are quantised to integers (1/1024 world units, 1/64
+// degree, 1/256 speed units, 1/65536 lap) and stored as the difference from a
+// linear prediction out of the two previous ticks. Cars move smoothly, so
+// most residuals are zero or tiny: a car costs a one-byte field mask plus a
+// few one-byte varints per tick instead of about 32 bytes of raw state.
+//
+// Every keyframeInterval ticks the prediction restarts from zero, so a
+// keyframe decodes on its own. Seeking jumps to the keyframe at or before the
+// target through the index and decodes forward, at most one interval of
+// ticks. The prediction works on the quantised values the decoder sees, so
+// rounding errors never accumulate.
+
+// State of one car in one replay tick (after dequantisation)
+struct ReplayCarState {
+    Vector2 position;     // Car position
+    float rotation;       // Orientation in degrees, [0, 360)
+    float wheelRotation;  // Wheel animation angle
+    float speed;          // Speed
+    float lapProgress;    // Fraction of the lap completed, [0, 1)
+    int lane;             // Lane index
+    int lap;              // Lap number
+    bool finished;        // Finished the race
+};
+
+// Appearance of one recorded car
+struct ReplayCarInfo {
+    std::string name;
+    int colorR, colorG, colorB; // 0-255
+};
+
+// -------------------- Tick Codec --------------------
+// The per-tick car encoding of the frames, shared by replay files and the
+// spectator stream (Spectator.h). Encoder and decoder keep the same two ticks
+// of prediction history; keyframe() restarts it from zero on both sides.
+class ReplayTickEncoder {
+public:
+    // Clears the history for 'carCount' cars
+    void reset(int carCount);
+
+    // Next encode() produces a tick that decodes on its own
+    void keyframe();
+
+    // Appends the tick's field masks and residuals to 'out'; 'cars' must have
+    // the count given to reset()
+    void encode(const std::vector<Car>& cars, std::vector<unsigned char>& out);
+
+private:
+    std::vector<std::int64_t> history; // Quantised fields of the last two ticks
+};
+
+class ReplayTickDecoder {
+public:
+    void reset(int carCount);
+    void keyframe();
+
+    // Decodes one tick from 'p' (advanced past it) into 'states', which must
+    // hold one entry per car; returns false on truncated data
+    bool decode(const unsigned char*& p, const unsigned char* end, std::vector<ReplayCarState>& states);
+
+private:
+    std::vector<std::int64_t> history;
+};
+
+// Car names and colors as stored after the track path: appends sim's cars to
+// 'out', or reads 'count' of them from 'p' (false if truncated)
+void encodeReplayCars(const Simulation& sim, std::vector<unsigned char>& out);
+bool decodeReplayCars(const unsigned char*& p, const unsigned char* end, std::uint32_t count,
+    std::vector<ReplayCarInfo>& cars);
+
+// Loads 'trackPath' (empty = built-in) into an empty Simulation and adds the
+// cars on the lanes of 'states' (lane 0 if 'states' is empty)
+bool setupReplayCars(Simulation& sim, const std::string& trackPath, const std::vector<ReplayCarInfo>& cars,
+    const std::vector<ReplayCarState>& states);
+
+// Writes decoded states into the cars' replayed fields, leaving the others
+void applyReplayStates(const std::vector<ReplayCarState>& states, std::vector<Car>& cars);
+
+// -------------------- ReplayWriter Class --------------------
+// Streams a race to a replay file, one record() per tick
+class ReplayWriter {
+public:
+    static const int kDefaultKeyframeInterval = 240; // Ticks between keyframes (1 s at 240 Hz)
+
+    ReplayWriter();
+    ~ReplayWriter();
+
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+
+    // -------------------- Recording --------------------
+    // Starts a replay of sim's cars; 'trackPath' is the track file the race
+    // uses (empty = built-in track). Returns false if the file cannot be created.
+    bool open(const std::string& path, const Simulation& sim, const std::string& trackPath,
+        float tickSeconds, int keyframeInterval = kDefaultKeyframeInterval);
+
+    // Appends the current state of 'cars' as the next tick; the car count
+    // must match the one given to open()
+    void record(const std::vector<Car>& cars);
+
+    // Writes the keyframe index and closes the file (also done by the
+    // destructor); returns false if any write failed
+    bool close();
+
+    bool isOpen() const { return file != nullptr; }
+    long long ticks() const { return tickCount; }       // Ticks recorded so far
+    long long bytes() const { return bytesWritten + static_cast<long long>(buffer.size()); } // Bytes so far
+
+private:
+    FILE* file;
+    std::string path;
+    int carCount;
+    int keyframeInterval;
+    long long tickCount;
+    long long bytesWritten;
+    bool failed;                               // A write failed
+    std::vector<std::uint64_t> keyframeOffsets; // File offset of every keyframe
+    ReplayTickEncoder encoder;
+    std::vector<unsigned char> buffer;         // Encoded bytes not yet written
+
+    void flush();
+};
+
+// -------------------- ReplayReader Class --------------------
+// Memory-maps a replay and decodes it tick by tick, with random access
+// through the keyframes
+class ReplayReader {
+public:
+    std::string trackPath;             // Track file of the race (empty = built-in)
+    float tickSeconds;                 // Simulated time per tick
+    int keyframeInterval;              // Ticks between keyframes
+    std::vector<ReplayCarInfo> cars;   // Names and colors, in car order
+
+    ReplayReader();
+
+    // -------------------- Loading --------------------
+    // Opens a replay; returns false (printing the reason) if it is missing,
+    // truncated or was not closed properly. Positions the reader at tick 0.
+    bool open(const std::string& path);
+
+    // Loads the replay's track into an empty Simulation and adds its cars
+    bool setup(Simulation& sim) const;
+
+    // -------------------- Playback --------------------
+    int tickCount() const { return ticks; }  // Recorded ticks
+    int tick() const { return current; }     // Tick held in states()
+
+    // Decodes 'tick' (clamped to the recording), starting from the nearest
+    // keyframe unless it lies just ahead; returns false on corrupt data
+    bool seek(int tick);
+
+    // Decodes the following tick; returns false at the end of the recording
+    bool next();
+
+    // Car states of the current tick
+    const std::vector<ReplayCarState>& states() const { return carStates; }
+
+    // Writes the current tick into the cars' replayed fields. The cars are
+    // meant to be drawn, not stepped: other fields are left untouched.
+    void apply(std::vector<Car>& cars) const;
+
+private:
+    MappedFile file;
+    const unsigned char* frames;       // First byte of the frame data
+    const unsigned char* framesEnd;    // End of the frame data
+    std::vector<std::uint64_t> keyframeOffsets;
+    int ticks;
+    int current;                       // Decoded tick, -1 before the first
+    const unsigned char* cursor;       // Start of tick current + 1
+    ReplayTickDecoder decoder;
+    std::vector<ReplayCarState> carStates;
+
+    // Decodes one tick at 'cursor'
+    bool decodeTick();
+};
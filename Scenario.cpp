@@ -0,0 +1,102 @@
+// Scenario.cpp : scenario file parsing and race setup.
+// Part of the GL-free simulation core.
+
+#include "Scenario.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+// -------------------- Path Helper --------------------
+// Resolves 'path' relative to the directory of 'base' unless it is absolute
+static std::string relativeTo(const std::string& base, const std::string& path) {
+    if (path.empty() || path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'))
+        return path;
+    size_t slash = base.find_last_of("/\\");
+    return slash == std::string::npos ? path : base.substr(0, slash + 1) + path;
+}
+
+// -------------------- Load --------------------
+bool Scenario::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        printf("Error: cannot open scenario file %s\n", path.c_str());
+        return false;
+    }
+
+    *this = Scenario();
+    std::string line;
+    int lineNumber = 0;
+    CarModel model = CarModel::Kinematic; // Set by 'model', applies to the lines below
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string key;
+        if (!(words >> key)) continue;
+
+        bool ok = true;
+        if (key == "track") {
+            ok = static_cast<bool>(words >> trackPath);
+            trackPath = relativeTo(path, trackPath);
+        }
+        else if (key == "seed") ok = static_cast<bool>(words >> seed);
+        else if (key == "grid") {
+            ok = static_cast<bool>(words >> gridCount) && gridCount >= 0;
+            gridModel = model;
+        }
+        else if (key == "model") {
+            std::string name;
+            ok = static_cast<bool>(words >> name) && parseCarModel(name.c_str(), model);
+        }
+        else if (key == "car") {
+            ScenarioCar car;
+            car.lane = -1;
+            car.gridRow = 0;
+            car.model = model;
+            ok = static_cast<bool>(words >> car.name >> car.r >> car.g >> car.b
+                >> car.maxSpeed >> car.speed >> car.accelerationFactor);
+            if (ok && (words >> car.lane)) ok = static_cast<bool>(words >> car.gridRow);
+            if (ok) cars.push_back(car);
+        }
+        else ok = false;
+
+        if (!ok) {
+            printf("Error: %s:%d: invalid line '%s'\n", path.c_str(), lineNumber, line.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// -------------------- Apply --------------------
+// Explicit cars without a lane take grid slots in order (slot i = lane
+// i % laneCount, row i / laneCount), exactly like Simulation::setupGrid
+bool Scenario::apply(Simulation& sim) const {
+    if (!trackPath.empty() && !sim.loadTrack(trackPath)) return false;
+
+    int laneCount = sim.track.laneCount();
+    sim.cars.reserve(cars.size() + gridCount);
+    for (const auto& config : cars) {
+        int slot = static_cast<int>(sim.cars.size());
+        int lane = config.lane >= 0 ? config.lane : slot % laneCount;
+        int row = config.lane >= 0 ? config.gridRow : slot / laneCount;
+        if (lane >= laneCount) {
+            printf("Error: car %s uses lane %d, the track has %d lanes\n", config.name.c_str(), lane, laneCount);
+            return false;
+        }
+
+        Car& car = sim.addCar(lane, row, config.r, config.g, config.b, config.name);
+        car.maxSpeed = config.maxSpeed;
+        car.speed = config.speed;
+        car.accelerationFactor = config.accelerationFactor;
+        car.model = config.model;
+    }
+
+    srand(seed);
+    int first = static_cast<int>(sim.cars.size());
+    sim.setupGrid(gridCount);
+    for (int i = first; i < static_cast<int>(sim.cars.size()); ++i)
+        sim.cars[i].model = gridModel;
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "Simulation.h"
+#include <string>
+#include <vector>
+
+// -------------------- Scenario Car --------------------
+// One explicitly configured car of a scenario
+struct ScenarioCar {
+    std::string name;            // Display name (single word)
+    float r, g, b;               // Body color (0-1)
+    float maxSpeed;              // Maximum achievable speed
+    float speed;                 // Starting speed
+    float accelerationFactor;    // Acceleration responsiveness
+    int lane;                    // Starting lane, -1 = next grid slot
+    int gridRow;                 // Rows behind the start line (used when lane >= 0)
+    CarModel model;              // Driving rules
+};
+
+// -------------------- Scenario Class --------------------
+// Text description of a race: which track to use and which cars start.
+// Keywords, one per line ('#' starts a comment):
+//   track PATH                        track file, relative to the scenario file
+//   seed S                            srand() seed for the randomised grid
+//   car NAME R G B MAX SPEED ACCEL [LANE ROW]
+//   grid N                            N more cars with randomised parameters
+//                                     (same as Simulation::setupGrid)
+//   model NAME                        model of the cars that follow (kinematic,
+//                                     grip or aggressive; default kinematic)
+class Scenario {
+public:
+    std::string trackPath;           // Empty = built-in elliptical track
+    unsigned int seed = 1;           // Seed for the randomised grid cars
+    std::vector<ScenarioCar> cars;   // Explicit cars, placed first
+    int gridCount = 0;               // Randomised cars added after the explicit ones
+    CarModel gridModel = CarModel::Kinematic; // Model of the randomised cars
+
+    // -------------------- Loading --------------------
+    // Parses a scenario file; returns false (printing the reason) on error
+    bool load(const std::string& path);
+
+    // -------------------- Setup --------------------
+    // Loads the track into an empty Simulation and places all cars on the grid
+    bool apply(Simulation& sim) const;
+};
@@ -0,0 +1,296 @@
+// Simulation.cpp : race setup and stepping for the GL-free simulation core.
+
+#include "Simulation.h"
+#include "Profiler.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+// -------------------- Constructor --------------------
+Simulation::Simulation()
+    : stepCount(0), useLaneIndex(true),
+    tickMode(TickMode::Sequential), pool(nullptr), collisions(false), events(nullptr), raceId(0)
+{
+}
+
+// -------------------- Track Loading --------------------
+// Cars hold lane indices, so the track may only be replaced while the grid is empty
+bool Simulation::loadTrack(const std::string& path) {
+    return cars.empty() && track.load(path);
+}
+
+bool Simulation::setTrack(const Track& shared) {
+    if (!cars.empty()) return false;
+    track = shared;
+    return true;
+}
+
+// -------------------- Add Car --------------------
+// Places a car on 'lane'; each grid row starts two track points further back
+Car& Simulation::addCar(int lane, int gridRow, float r, float g, float b, const std::string& name) {
+    LaneView lanePoints = track.lanePoints(lane);
+    int n = lanePoints.size();
+    int start = ((-2 * gridRow) % n + n) % n; // Start point index, wrapped onto the lane
+
+    Car car(lanePoints[start], r, g, b, lane);
+    car.placeOnLane(track, lane, start);
+    if (gridRow > 0) car.lap = -1; // Starts behind the line: crossing it begins lap 0
+    cars.push_back(car);
+    carNames.push_back(name);
+    return cars.back();
+}
+
+// -------------------- Grid Setup --------------------
+// Reproduces the original three-car field (BMW red, Mercedes green, Ford blue)
+// and extends it with numbered cars for larger fields. Cars already on the grid
+// keep their slots; the new ones fill the following slots.
+void Simulation::setupGrid(int count) {
+    static const char* baseNames[] = { "BMW", "Mercedes", "Ford" };
+    int laneCount = track.laneCount();
+    int first = static_cast<int>(cars.size());
+
+    cars.reserve(cars.size() + count);
+    for (int i = first; i < first + count; ++i) {
+        // Assign distinct RGB color for each car
+        float r = (i % 3 == 0) ? 1.0f : 0.0f;
+        float g = (i % 3 == 1) ? 1.0f : 0.0f;
+        float b = (i % 3 == 2) ? 1.0f : 0.0f;
+        std::string name = (i < 3) ? baseNames[i] : "Car " + std::to_string(i + 1);
+
+        Car& car = addCar(i % laneCount, i / laneCount, r, g, b, name);
+        car.maxSpeed = 4.8f + static_cast<float>(rand()) / RAND_MAX * 0.5f;
+        car.speed = 1.0f + static_cast<float>(rand()) / RAND_MAX;
+        car.accelerationFactor = 1.8f + static_cast<float>(rand()) / RAND_MAX * 0.5f;
+    }
+}
+
+// -------------------- Occupancy Refresh --------------------
+// Files every car under its lane, ordered by progress along the lap
+void Simulation::refreshOccupancy(const std::vector<Car>& source) {
+    PROFILE_SCOPE("occupancy");
+    int n = static_cast<int>(source.size());
+    carLanes.resize(n);
+    carKeys.resize(n);
+    for (int i = 0; i < n; ++i) {
+        carLanes[i] = source[i].laneIndex;
+        carKeys[i] = source[i].progressKey();
+    }
+    occupancy.update(track.laneCount(), n, carLanes.data(), carKeys.data());
+}
+
+// -------------------- Simulation Step --------------------
+// Sequential mode updates all cars in order; each car sees the cars updated
+// before it this tick
+void Simulation::step(float dt) {
+    PROFILE_SCOPE("Simulation::step");
+    if (tickMode == TickMode::DoubleBuffered) {
+        stepDoubleBuffered(dt);
+    }
+    else if (!useLaneIndex) {
+        for (auto& car : cars)
+            car.update(dt, track, &cars);
+    }
+    else {
+        refreshOccupancy(cars);
+        for (int i = 0; i < static_cast<int>(cars.size()); ++i)
+            cars[i].update(dt, track, cars, occupancy, i);
+    }
+    if (collisions) resolveCollisions();
+    ++stepCount;
+    updateStandings();
+}
+
+// -------------------- Collisions --------------------
+// The collider works on field arrays (like CarFleet's), so the cars are
+// gathered into scratch arrays and the changed fields written back
+void Simulation::resolveCollisions() {
+    PROFILE_SCOPE("collisions");
+    int n = static_cast<int>(cars.size());
+    for (auto* field : { &bodyX, &bodyY, &bodyRotation, &bodySize, &bodyOffsetX, &bodyOffsetY, &bodySpeed })
+        field->resize(n);
+    for (int i = 0; i < n; ++i) {
+        const Car& car = cars[i];
+        bodyX[i] = car.position.x;
+        bodyY[i] = car.position.y;
+        bodyRotation[i] = car.rotation;
+        bodySize[i] = car.size;
+    }
+    collider.detect(n, bodyX.data(), bodyY.data(), bodyRotation.data(), bodySize.data());
+    if (collider.contacts().empty()) return;
+
+    for (int i = 0; i < n; ++i) {
+        bodyOffsetX[i] = cars[i].laneOffset.x;
+        bodyOffsetY[i] = cars[i].laneOffset.y;
+        bodySpeed[i] = cars[i].speed;
+    }
+    collider.resolve(bodyX.data(), bodyY.data(), bodyOffsetX.data(), bodyOffsetY.data(), bodySpeed.data());
+    for (int i = 0; i < n; ++i) {
+        Car& car = cars[i];
+        car.position = Vector2(bodyX[i], bodyY[i]);
+        car.laneOffset = Vector2(bodyOffsetX[i], bodyOffsetY[i]);
+        car.speed = bodySpeed[i];
+    }
+}
+
+// -------------------- Standings --------------------
+void Simulation::updateStandings() {
+    PROFILE_SCOPE("standings");
+    int n = static_cast<int>(cars.size());
+    carProgress.resize(n);
+    for (int i = 0; i < n; ++i)
+        carProgress[i] = cars[i].raceProgress();
+    overtakes.clear();
+    standings.update(n, carProgress.data(), events ? &overtakes : nullptr);
+    if (events) publishEvents();
+}
+
+// -------------------- Race Events --------------------
+// Laps and lanes are compared with the last published state, overtakes come
+// from the standings' adjacent swaps
+void Simulation::publishEvents() {
+    int n = static_cast<int>(cars.size());
+    bool baseline = static_cast<int>(eventLaps.size()) != n;
+    eventLaps.resize(n);
+    eventLanes.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const Car& car = cars[i];
+        if (!baseline && car.lap != eventLaps[i])
+            events->emit({ stepCount, raceId, i, car.lap, 0, RaceEventType::Lap });
+        if (!baseline && car.laneIndex != eventLanes[i])
+            events->emit({ stepCount, raceId, i, eventLanes[i], car.laneIndex, RaceEventType::LaneChange });
+        eventLaps[i] = car.lap;
+        eventLanes[i] = car.laneIndex;
+    }
+    if (baseline) return;
+    for (const auto& overtake : overtakes)
+        events->emit({ stepCount, raceId, overtake.car, overtake.passed, overtake.position, RaceEventType::Overtake });
+}
+
+// -------------------- Double-Buffered Step --------------------
+// The state at the start of the tick is swapped into previousCars and stays
+// untouched while 'cars' is rebuilt from it. Each car copies its own previous
+// state and updates against the snapshot, so no car can observe another car's
+// new state and the outcome does not depend on update order or thread count.
+void Simulation::stepDoubleBuffered(float dt) {
+    if (previousCars.size() != cars.size()) previousCars = cars; // (Re)size the back buffer
+    cars.swap(previousCars);
+
+    const std::vector<Car>& snapshot = previousCars;
+    refreshOccupancy(snapshot);
+
+    auto updateRange = [this, dt, &snapshot](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            cars[i] = snapshot[i];
+            cars[i].update(dt, track, snapshot, occupancy, i);
+        }
+    };
+
+    int n = static_cast<int>(cars.size());
+    if (pool) pool->parallelFor(n, updateRange);
+    else updateRange(0, n);
+}
+
+// -------------------- Snapshots --------------------
+// Layout: SnapshotHeader, the Car array as raw bytes, then per car a uint32
+// name length followed by the name. The track is identified by its lane and
+// point counts and lap length rather than copied.
+static const char kSnapshotMagic[8] = { 'D', 'R', 'S', 'S', 'N', 'A', 'P', '1' };
+
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t carSize;      // sizeof(Car) of the build that wrote it
+    std::uint32_t carCount;
+    std::uint32_t laneCount;
+    std::uint32_t pointCount;
+    float lapLength;            // Length of lane 0
+    std::int64_t stepCount;
+};
+
+static_assert(std::is_trivially_copyable<Car>::value, "Cars are snapshotted as raw bytes");
+
+void Simulation::snapshot(SimSnapshot& out) const {
+    size_t carBytes = cars.size() * sizeof(Car);
+    size_t size = sizeof(SnapshotHeader) + carBytes;
+    for (const auto& name : carNames) size += sizeof(std::uint32_t) + name.size();
+    out.bytes.resize(size);
+
+    SnapshotHeader header = {};
+    memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.carSize = sizeof(Car);
+    header.carCount = static_cast<std::uint32_t>(cars.size());
+    header.laneCount = static_cast<std::uint32_t>(track.laneCount());
+    header.pointCount = static_cast<std::uint32_t>(track.pointCount());
+    header.lapLength = track.laneLength(0);
+    header.stepCount = stepCount;
+
+    unsigned char* p = out.bytes.data();
+    memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    if (carBytes) memcpy(p, cars.data(), carBytes);
+    p += carBytes;
+    for (const auto& name : carNames) {
+        std::uint32_t length = static_cast<std::uint32_t>(name.size());
+        memcpy(p, &length, sizeof(length));
+        memcpy(p + sizeof(length), name.data(), length);
+        p += sizeof(length) + length;
+    }
+}
+
+bool Simulation::restore(const SimSnapshot& in) {
+    SnapshotHeader header;
+    const unsigned char* p = in.bytes.data();
+    const unsigned char* end = p + in.bytes.size();
+    if (in.bytes.size() < sizeof(header)) return false;
+    memcpy(&header, p, sizeof(header));
+    p += sizeof(header);
+
+    size_t carBytes = static_cast<size_t>(header.carCount) * sizeof(Car);
+    if (memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0 || header.carSize != sizeof(Car) ||
+        static_cast<size_t>(end - p) < carBytes ||
+        header.laneCount != static_cast<std::uint32_t>(track.laneCount()) ||
+        header.pointCount != static_cast<std::uint32_t>(track.pointCount()) || header.lapLength != track.laneLength(0))
+        return false;
+
+    // Names are validated before anything is modified
+    const unsigned char* names = p + carBytes;
+    const unsigned char* q = names;
+    for (std::uint32_t i = 0; i < header.carCount; ++i) {
+        std::uint32_t length;
+        if (static_cast<size_t>(end - q) < sizeof(length)) return false;
+        memcpy(&length, q, sizeof(length));
+        if (static_cast<size_t>(end - q) - sizeof(length) < length) return false;
+        q += sizeof(length) + length;
+    }
+
+    if (cars.size() != header.carCount)
+        cars.assign(header.carCount, Car(Vector2(0, 0), 0.0f, 0.0f, 0.0f, 0));
+    if (carBytes) memcpy(cars.data(), p, carBytes);
+    carNames.resize(header.carCount);
+    q = names;
+    for (std::uint32_t i = 0; i < header.carCount; ++i) {
+        std::uint32_t length;
+        memcpy(&length, q, sizeof(length));
+        carNames[i].assign(reinterpret_cast<const char*>(q + sizeof(length)), length);
+        q += sizeof(length) + length;
+    }
+    stepCount = header.stepCount;
+
+    savePoses();
+    rebaseEvents(); // Jumping back in time is not a race event
+    updateStandings();
+    return true;
+}
+
+// -------------------- Render Interpolation --------------------
+void Simulation::savePoses() {
+    previousPoses.resize(cars.size());
+    for (size_t i = 0; i < cars.size(); ++i)
+        previousPoses[i] = cars[i].pose();
+}
+
+// Cars added since the last savePoses() are drawn at their current pose
+CarPose Simulation::renderPose(int i, float alpha) const {
+    if (i >= static_cast<int>(previousPoses.size())) return cars[i].pose();
+    return interpolatePose(previousPoses[i], cars[i].pose(), alpha);
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include "Car.h"
+#include "CarCollisions.h"
+#include "Track.h"
+#include "LaneOccupancy.h"
+#include "Standings.h"
+#include "RaceEvents.h"
+#include "ThreadPool.h"
+#include <string>
+#include <vector>
+
+// -------------------- Snapshot --------------------
+// Flat, pointer-free copy of a Simulation's race state (see Simulation::snapshot).
+// Cars are stored as raw bytes, so a snapshot is only valid for the build that
+// took it: it is meant for in-process checkpoints, not archiving (use replays).
+struct SimSnapshot {
+    std::vector<unsigned char> bytes;
+};
+
+// -------------------- Simulation Class --------------------
+// GL-free container for the complete race state: track geometry and cars.
+// Both the GLUT application (main.cpp) and the headless runner
+// (headless_main.cpp) advance the race exclusively through step().
+// Cars refer to lanes by index, so the race state can be captured with
+// snapshot() and put back with restore() (checkpoints, rewind, what-if branches).
+class Simulation {
+public:
+    // -------------------- Tick Modes --------------------
+    // Sequential:     cars update in vector order and see neighbours already
+    //                 moved this tick (original behaviour, single threaded)
+    // DoubleBuffered: every car reads an immutable snapshot of the previous
+    //                 tick and writes only its own slot of the next state, so
+    //                 cars can be split across a thread pool and the result is
+    //                 identical for any thread count
+    enum class TickMode { Sequential, DoubleBuffered };
+
+    // -------------------- Race State --------------------
+    Track track;                                  // Track geometry
+    std::vector<Car> cars;                        // All cars in the race
+    std::vector<std::string> carNames;            // Display name per car (same order as cars)
+    long long stepCount;                          // Steps taken since the grid was set up
+
+    // -------------------- Neighbour Search --------------------
+    LaneOccupancy occupancy;                      // Per-lane cars ordered by progress
+    bool useLaneIndex;                            // false = legacy all-cars scan (Sequential mode only)
+
+    // -------------------- Race Order --------------------
+    Standings standings;                          // Cars by race progress, refreshed every step
+
+    // -------------------- Tick Scheduling --------------------
+    TickMode tickMode;                            // How cars are stepped (see TickMode)
+    ThreadPool* pool;                             // Workers for DoubleBuffered ticks (nullptr = caller only)
+
+    // -------------------- Collisions --------------------
+    // Off by default: cars then only avoid each other through their traffic rules
+    bool collisions;                              // Separate overlapping cars after every step
+    CarCollisions collider;                       // Broadphase state and the last step's contacts
+
+    // -------------------- Race Events --------------------
+    // Laps, lane changes and overtakes are found by updateStandings() and
+    // emitted from the calling thread (never blocking on the stream)
+    EventStream* events;                          // Receives this race's events (nullptr = none)
+    int raceId;                                   // Tags this race's events
+
+    // -------------------- Constructor --------------------
+    // Builds the default track
+    Simulation();
+
+    // The track is large and never changes during a race: copy race state
+    // with snapshot()/restore() instead of copying a Simulation
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // -------------------- Race Setup --------------------
+    // Replaces the default track with a track file (see Track::load).
+    // Must be called before any car is added; returns false on error.
+    bool loadTrack(const std::string& path);
+
+    // Races on 'shared' (e.g. a track loaded once for many concurrent races);
+    // the geometry is shared, not copied. Same precondition as loadTrack().
+    bool setTrack(const Track& shared);
+
+    // Adds a car at the start of the given lane, 'gridRow' rows behind the start line
+    Car& addCar(int lane, int gridRow, float r, float g, float b, const std::string& name);
+
+    // Adds 'count' cars spread across the lanes with randomised speed parameters,
+    // continuing after any cars already on the grid.
+    // Uses rand(), so callers control reproducibility through srand().
+    void setupGrid(int count);
+
+    // -------------------- Simulation Step --------------------
+    // Advances every car by dt seconds using the current tick mode, then
+    // updates the standings
+    void step(float dt);
+
+    // Re-ranks the cars by race progress and emits the race events since the
+    // previous call; step() calls this, callers only need it after changing
+    // cars outside step() (e.g. right after setup, or after a CarFleet step)
+    void updateStandings();
+
+    // Makes the current state the baseline for race events, so a jump (a
+    // replay seek, a restored snapshot) is not reported as laps and overtakes
+    void rebaseEvents() { eventLaps.clear(); }
+
+    // -------------------- Snapshots --------------------
+    // Copies the race state (cars, names, step count) into 'out', reusing its
+    // buffer. Takes microseconds for thousands of cars.
+    void snapshot(SimSnapshot& out) const;
+
+    // Puts back a snapshot taken on the same track. Render poses are reset
+    // to the restored state. Returns false (leaving the race untouched) if
+    // the snapshot is invalid or was taken on a different track.
+    bool restore(const SimSnapshot& in);
+
+    // -------------------- Render Interpolation --------------------
+    // Remembers the current car poses as the "previous tick"; call right
+    // before the last step of a frame
+    void savePoses();
+
+    // Pose of car i blended 'alpha' of the way from the saved poses to the
+    // current state (alpha = FixedStepClock::alpha())
+    CarPose renderPose(int i, float alpha) const;
+
+private:
+    std::vector<Car> previousCars; // DoubleBuffered: read-only state of the previous tick
+    std::vector<int> carLanes;     // Scratch: lane of each car for the occupancy update
+    std::vector<float> carKeys;    // Scratch: progress key of each car
+    std::vector<float> carProgress; // Scratch: race progress of each car for the standings
+    std::vector<CarPose> previousPoses; // Poses saved by savePoses()
+    std::vector<int> eventLaps;    // Lap of each car when events were last emitted
+    std::vector<int> eventLanes;   // Lane of each car when events were last emitted
+    std::vector<Standings::Overtake> overtakes; // Scratch: overtakes of the current update
+    std::vector<float> bodyX, bodyY, bodyRotation, bodySize; // Scratch: collision input per car
+    std::vector<float> bodyOffsetX, bodyOffsetY, bodySpeed;  // Scratch: fields changed by resolution
+
+    // Emits lap, lane change and overtake events since the last call; a new
+    // field (or one just restored) only records the baseline
+    void publishEvents();
+
+    // Rebuilds the occupancy index from the given car state
+    void refreshOccupancy(const std::vector<Car>& source);
+
+    // DoubleBuffered tick: snapshot read, per-car write, optionally on the pool
+    void stepDoubleBuffered(float dt);
+
+    // Finds overlapping cars and pushes them apart (after the cars moved)
+    void resolveCollisions();
+};
@@ -0,0 +1,69 @@
+// SpatialGrid.cpp : uniform grid index for view culling.
+// Part of the GL-free simulation core.
+
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+// -------------------- Constructor --------------------
+SpatialGrid::SpatialGrid()
+    : bounds{ 0.0f, 0.0f, 0.0f, 0.0f }, cellSize(1.0f), columns(1), rows(1)
+{
+    cellStart.assign(2, 0);
+}
+
+// -------------------- Layout --------------------
+void SpatialGrid::reset(const ViewRect& area, float size) {
+    bounds = area;
+    cellSize = size > 0.0f ? size : 1.0f;
+    columns = std::max(1, static_cast<int>(std::ceil((bounds.maxX - bounds.minX) / cellSize)));
+    rows = std::max(1, static_cast<int>(std::ceil((bounds.maxY - bounds.minY) / cellSize)));
+    cellStart.assign(cellCount() + 1, 0);
+    items.clear();
+}
+
+int SpatialGrid::columnOf(float x) const {
+    int column = static_cast<int>(std::floor((x - bounds.minX) / cellSize));
+    return std::max(0, std::min(column, columns - 1));
+}
+
+int SpatialGrid::rowOf(float y) const {
+    int row = static_cast<int>(std::floor((y - bounds.minY) / cellSize));
+    return std::max(0, std::min(row, rows - 1));
+}
+
+// -------------------- Building --------------------
+// Counting sort by cell: count, prefix sum, scatter
+void SpatialGrid::buildBoxes(const std::vector<ViewRect>& list) {
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+    auto forEachCell = [this](const ViewRect& box, auto&& visit) {
+        int c0 = columnOf(box.minX), c1 = columnOf(box.maxX);
+        int r0 = rowOf(box.minY), r1 = rowOf(box.maxY);
+        for (int r = r0; r <= r1; ++r)
+            for (int c = c0; c <= c1; ++c) visit(r * columns + c);
+    };
+    for (const auto& box : list)
+        forEachCell(box, [this](int cell) { ++cellStart[cell + 1]; });
+    for (int c = 0; c < cellCount(); ++c) cellStart[c + 1] += cellStart[c];
+
+    items.resize(cellStart.back());
+    std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+    for (int i = 0; i < static_cast<int>(list.size()); ++i)
+        forEachCell(list[i], [this, &fill, i](int cell) { items[fill[cell]++] = i; });
+}
+
+// -------------------- Queries --------------------
+void SpatialGrid::query(const ViewRect& rect, std::vector<int>& out) const {
+    out.clear();
+    // Boxes are meant to lie inside the grid, so a rectangle outside it holds none
+    if (!rect.overlaps(bounds)) return;
+    int c0 = columnOf(rect.minX), c1 = columnOf(rect.maxX);
+    int r0 = rowOf(rect.minY), r1 = rowOf(rect.maxY);
+    for (int r = r0; r <= r1; ++r) {
+        int begin = cellStart[r * columns + c0];
+        int end = cellStart[r * columns + c1 + 1];  // Cells of a row are contiguous
+        out.insert(out.end(), items.begin() + begin, items.begin() + end);
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
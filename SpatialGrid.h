@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+
+// -------------------- View Rectangle --------------------
+// Axis-aligned world rectangle (a view, or the bounds of an item)
+struct ViewRect {
+    float minX, minY, maxX, maxY;
+
+    bool overlaps(const ViewRect& other) const {
+        return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+    }
+
+    // The rectangle grown by 'margin' on every side
+    ViewRect expanded(float margin) const {
+        return { minX - margin, minY - margin, maxX + margin, maxY + margin };
+    }
+};
+
+// -------------------- SpatialGrid Class --------------------
+// Uniform grid over a world rectangle that answers "which items may lie in
+// this rectangle" by visiting only the cells the rectangle covers, so the
+// cost of a query follows the size of the answer rather than the item count.
+//
+// Items are boxes (track chunks), filed once per build into every cell they
+// overlap, in compressed rows: cellStart[c] .. cellStart[c + 1] index the
+// items of cell c in one flat array, so a build is two linear passes with no
+// per-cell allocation.
+class SpatialGrid {
+public:
+    // -------------------- Constructor --------------------
+    SpatialGrid();
+
+    // -------------------- Layout --------------------
+    // Covers 'bounds' with square cells of side 'cellSize' (at least one cell)
+    // and drops all items
+    void reset(const ViewRect& bounds, float cellSize);
+
+    // -------------------- Building --------------------
+    // Files item i in every cell overlapped by boxes[i]; the grid should cover all boxes
+    void buildBoxes(const std::vector<ViewRect>& boxes);
+
+    // -------------------- Queries --------------------
+    // Ids of the items filed in cells overlapping 'rect', each once and in
+    // ascending order (so drawing order matches the item order). Candidates
+    // only: an item near the rectangle may be returned without overlapping it.
+    void query(const ViewRect& rect, std::vector<int>& out) const;
+
+    int cellCount() const { return columns * rows; }
+
+private:
+    ViewRect bounds;                // Covered area
+    float cellSize;
+    int columns, rows;
+    std::vector<int> cellStart;     // Items of cell c are items[cellStart[c] .. cellStart[c + 1])
+    std::vector<int> items;         // Item ids grouped by cell
+
+    // Cell column / row holding world x / y, clamped to the grid
+    int columnOf(float x) const;
+    int rowOf(float y) const;
+};
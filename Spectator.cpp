@@ -0,0 +1,435 @@
+// Spectator.cpp : live race streaming to local viewers over Unix domain sockets.
+// Part of the GL-free simulation core.
+
+#include "Spectator.h"
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0   // macOS: SIGPIPE is disabled per socket with SO_NOSIGPIPE instead
+#endif
+
+// -------------------- Stream Layout --------------------
+//   message: uint32 length (type byte + payload), type byte, payload
+//   Hello payload: SpectatorHello, track path, car table (as in replays)
+//   Keyframe / Delta payload: int64 tick, encoded cars
+static const char kSpectatorMagic[8] = { 'D', 'R', 'S', 'S', 'P', 'E', 'C', 'T' };
+static const std::uint32_t kSpectatorVersion = 1;   // Bump when the stream or the replay encoding changes
+static const std::uint32_t kSpectatorEndianTag = 0x01020304;
+
+enum SpectatorMessage : unsigned char { kHelloMessage, kKeyframeMessage, kDeltaMessage };
+
+struct SpectatorHello {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endianTag;
+    std::uint32_t carCount;
+    std::uint32_t keyframeInterval;
+    float tickSeconds;
+    std::uint32_t trackPathLength;
+};
+
+// Starts a message in 'out'; finishMessage() fills in the length
+static void beginMessage(std::vector<unsigned char>& out, SpectatorMessage type) {
+    out.assign(5, 0);
+    out[4] = type;
+}
+
+static void finishMessage(std::vector<unsigned char>& out) {
+    std::uint32_t length = static_cast<std::uint32_t>(out.size() - 4);
+    memcpy(out.data(), &length, sizeof(length));
+}
+
+static void appendBytes(std::vector<unsigned char>& out, const void* data, size_t size) {
+    const unsigned char* raw = static_cast<const unsigned char*>(data);
+    out.insert(out.end(), raw, raw + size);
+}
+
+// ==================== SpectatorServer ====================
+
+// -------------------- Constructor --------------------
+SpectatorServer::SpectatorServer()
+    : listenSocket(-1), carCount(0), keyframeInterval(kDefaultKeyframeInterval), queueLimit(kDefaultQueueLimit),
+    tickCount(0), skippedTicks(0), sentBytes(0)
+{
+}
+
+SpectatorServer::~SpectatorServer() {
+    close();
+}
+
+// -------------------- Publishing --------------------
+bool SpectatorServer::open(const std::string& socketPath, const Simulation& sim, const std::string& trackPath,
+    float tickSeconds, int interval, size_t limit) {
+    close();
+#ifdef _WIN32
+    printf("Error: spectator streams need Unix domain sockets (%s)\n", socketPath.c_str());
+    return false;
+#else
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        printf("Error: spectator socket path %s is too long\n", socketPath.c_str());
+        return false;
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath.c_str()); // Left behind by a previous run
+    if (listenSocket < 0 || bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenSocket, 16) != 0) {
+        printf("Error: could not create spectator socket %s (%s)\n", socketPath.c_str(), strerror(errno));
+        if (listenSocket >= 0) ::close(listenSocket);
+        listenSocket = -1;
+        return false;
+    }
+    fcntl(listenSocket, F_SETFL, fcntl(listenSocket, F_GETFL) | O_NONBLOCK);
+#endif
+
+    path = socketPath;
+    carCount = static_cast<int>(sim.cars.size());
+    keyframeInterval = interval > 0 ? interval : kDefaultKeyframeInterval;
+    queueLimit = limit;
+    tickCount = skippedTicks = sentBytes = 0;
+    encoder.reset(carCount);
+
+    SpectatorHello header = {};
+    memcpy(header.magic, kSpectatorMagic, sizeof(header.magic));
+    header.version = kSpectatorVersion;
+    header.endianTag = kSpectatorEndianTag;
+    header.carCount = static_cast<std::uint32_t>(carCount);
+    header.keyframeInterval = static_cast<std::uint32_t>(keyframeInterval);
+    header.tickSeconds = tickSeconds;
+    header.trackPathLength = static_cast<std::uint32_t>(trackPath.size());
+
+    std::vector<unsigned char> message;
+    beginMessage(message, kHelloMessage);
+    appendBytes(message, &header, sizeof(header));
+    appendBytes(message, trackPath.data(), trackPath.size());
+    encodeReplayCars(sim, message);
+    finishMessage(message);
+    hello = std::make_shared<const std::vector<unsigned char>>(std::move(message));
+    return true;
+}
+
+// The tick is encoded once; every synced spectator queues the same bytes
+void SpectatorServer::publish(const std::vector<Car>& cars) {
+    if (!isOpen()) return;
+    if (static_cast<int>(cars.size()) != carCount) {
+        printf("Error: spectator stream %s expects %d cars, got %d\n", path.c_str(), carCount, static_cast<int>(cars.size()));
+        close();
+        return;
+    }
+    acceptSpectators();
+
+    bool keyframe = tickCount % keyframeInterval == 0;
+    if (keyframe) encoder.keyframe();
+    std::int64_t tick = tickCount++;
+    std::vector<unsigned char> bytes;
+    beginMessage(bytes, keyframe ? kKeyframeMessage : kDeltaMessage);
+    appendBytes(bytes, &tick, sizeof(tick));
+    encoder.encode(cars, bytes);
+    finishMessage(bytes);
+    Message message = std::make_shared<const std::vector<unsigned char>>(std::move(bytes));
+
+    for (size_t i = 0; i < spectators.size();) {
+        Spectator& spectator = spectators[i];
+        if (spectator.synced && spectator.queuedBytes > queueLimit) {
+            // Too far behind: keep only what it must still receive (a partly
+            // sent message, the hello) and wait for the next keyframe
+            std::deque<Message> kept;
+            size_t keptBytes = 0;
+            for (size_t m = 0; m < spectator.queue.size(); ++m) {
+                if ((m == 0 && spectator.offset > 0) || spectator.queue[m] == hello) {
+                    kept.push_back(spectator.queue[m]);
+                    keptBytes += spectator.queue[m]->size() - (m == 0 ? spectator.offset : 0);
+                }
+            }
+            if (kept.empty()) spectator.offset = 0;
+            spectator.queue.swap(kept);
+            spectator.queuedBytes = keptBytes;
+            spectator.synced = false;
+        }
+        if (!spectator.synced && keyframe && spectator.queuedBytes <= queueLimit) spectator.synced = true;
+
+        if (spectator.synced) enqueue(spectator, message);
+        else ++skippedTicks;
+
+        if (flush(spectator)) {
+            ++i;
+        }
+        else {
+#ifndef _WIN32
+            ::close(spectator.socket);
+#endif
+            spectators.erase(spectators.begin() + i);
+        }
+    }
+}
+
+void SpectatorServer::close() {
+#ifndef _WIN32
+    for (const Spectator& spectator : spectators)
+        ::close(spectator.socket);
+    if (listenSocket >= 0) {
+        ::close(listenSocket);
+        unlink(path.c_str());
+    }
+#endif
+    spectators.clear();
+    listenSocket = -1;
+    hello.reset();
+}
+
+// -------------------- Spectators --------------------
+void SpectatorServer::acceptSpectators() {
+#ifndef _WIN32
+    for (;;) {
+        int client = accept(listenSocket, nullptr, nullptr);
+        if (client < 0) return; // EAGAIN: nobody else is waiting
+        fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        Spectator spectator;
+        spectator.socket = client;
+        spectator.offset = 0;
+        spectator.queuedBytes = 0;
+        spectator.synced = false;
+        enqueue(spectator, hello);
+        spectators.push_back(std::move(spectator));
+    }
+#endif
+}
+
+void SpectatorServer::enqueue(Spectator& spectator, const Message& message) {
+    spectator.queue.push_back(message);
+    spectator.queuedBytes += message->size();
+}
+
+bool SpectatorServer::flush(Spectator& spectator) {
+#ifdef _WIN32
+    return false;
+#else
+    while (!spectator.queue.empty()) {
+        const std::vector<unsigned char>& front = *spectator.queue.front();
+        ssize_t sent = send(spectator.socket, front.data() + spectator.offset, front.size() - spectator.offset,
+            MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK; // Full socket buffer: try again next tick
+        }
+        spectator.offset += static_cast<size_t>(sent);
+        spectator.queuedBytes -= static_cast<size_t>(sent);
+        sentBytes += sent;
+        if (spectator.offset == front.size()) {
+            spectator.queue.pop_front();
+            spectator.offset = 0;
+        }
+    }
+    return true;
+#endif
+}
+
+// ==================== SpectatorClient ====================
+
+// -------------------- Constructor --------------------
+SpectatorClient::SpectatorClient()
+    : tickSeconds(0.0f), socket(-1), readOffset(0), current(-1), missed(0)
+{
+}
+
+SpectatorClient::~SpectatorClient() {
+    disconnect();
+}
+
+// -------------------- Connection --------------------
+bool SpectatorClient::connect(const std::string& socketPath) {
+    disconnect();
+    buffer.clear();
+    readOffset = 0;
+    current = -1;
+    missed = 0;
+#ifdef _WIN32
+    printf("Error: spectator streams need Unix domain sockets (%s)\n", socketPath.c_str());
+    return false;
+#else
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        printf("Error: spectator socket path %s is too long\n", socketPath.c_str());
+        return false;
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket < 0 || ::connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        printf("Error: could not connect to spectator socket %s (%s)\n", socketPath.c_str(), strerror(errno));
+        disconnect();
+        return false;
+    }
+    timeval timeout = { 5, 0 }; // Waits below give up when the server stalls
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+
+    // Header: tick rate, track and cars
+    unsigned char type;
+    const unsigned char* payload;
+    size_t size;
+    bool received = peekMessage(type, payload, size);
+    while (!received && receive(true))
+        received = peekMessage(type, payload, size);
+    SpectatorHello header;
+    bool ok = received && type == kHelloMessage && size >= sizeof(header);
+    if (ok) {
+        memcpy(&header, payload, sizeof(header));
+        ok = memcmp(header.magic, kSpectatorMagic, sizeof(header.magic)) == 0 &&
+             header.version == kSpectatorVersion && header.endianTag == kSpectatorEndianTag &&
+             sizeof(header) + header.trackPathLength <= size;
+    }
+    if (ok) {
+        const unsigned char* p = payload + sizeof(header);
+        const unsigned char* end = payload + size;
+        tickSeconds = header.tickSeconds;
+        trackPath.assign(reinterpret_cast<const char*>(p), header.trackPathLength);
+        p += header.trackPathLength;
+        ok = decodeReplayCars(p, end, header.carCount, cars) && p == end;
+    }
+    if (!ok) {
+        printf("Error: %s is not a spectator stream (version %u expected)\n", socketPath.c_str(), kSpectatorVersion);
+        disconnect();
+        return false;
+    }
+    readOffset += 5 + size;
+    decoder.reset(static_cast<int>(cars.size()));
+    carStates.assign(cars.size(), ReplayCarState());
+
+    // The server starts every spectator at a keyframe
+    while (!next()) {
+        if (!receive(true)) {
+            printf("Error: no race state received from %s\n", socketPath.c_str());
+            disconnect();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SpectatorClient::setup(Simulation& sim) const {
+    return setupReplayCars(sim, trackPath, cars, carStates);
+}
+
+void SpectatorClient::disconnect() {
+#ifndef _WIN32
+    if (socket >= 0) ::close(socket);
+#endif
+    socket = -1;
+}
+
+// Reads until the socket is empty, at most 1 MB per call so a fast server
+// cannot keep the caller here
+bool SpectatorClient::receive(bool wait) {
+#ifdef _WIN32
+    return false;
+#else
+    if (socket < 0) return false;
+    if (readOffset > 0 && readOffset * 2 >= buffer.size()) {
+        buffer.erase(buffer.begin(), buffer.begin() + readOffset);
+        readOffset = 0;
+    }
+
+    const size_t chunk = 64 * 1024;
+    bool received = false;
+    for (int reads = 0; reads < 16; ++reads) {
+        size_t used = buffer.size();
+        buffer.resize(used + chunk);
+        ssize_t count = recv(socket, buffer.data() + used, chunk, received || !wait ? MSG_DONTWAIT : 0);
+        buffer.resize(used + (count > 0 ? static_cast<size_t>(count) : 0));
+        if (count > 0) {
+            received = true;
+            continue;
+        }
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break; // Nothing more (or timed out)
+        disconnect(); // Closed by the server, or failed
+        return received;
+    }
+    return received || !wait;
+#endif
+}
+
+// -------------------- Playback --------------------
+bool SpectatorClient::peekMessage(unsigned char& type, const unsigned char*& payload, size_t& size) const {
+    size_t available = buffer.size() - readOffset;
+    std::uint32_t length;
+    if (available < sizeof(length)) return false;
+    memcpy(&length, buffer.data() + readOffset, sizeof(length));
+    if (length == 0 || available - sizeof(length) < length) return false;
+    type = buffer[readOffset + 4];
+    payload = buffer.data() + readOffset + 5;
+    size = length - 1;
+    return true;
+}
+
+bool SpectatorClient::next() {
+    unsigned char type;
+    const unsigned char* payload;
+    size_t size;
+    if (!peekMessage(type, payload, size)) {
+        receive(false);
+        if (!peekMessage(type, payload, size)) return false;
+    }
+    return decodeMessage(payload, size, type);
+}
+
+// A delta must follow the previous tick; a keyframe may follow a gap
+bool SpectatorClient::decodeMessage(const unsigned char* payload, size_t size, unsigned char type) {
+    std::int64_t tick = -1;
+    if (size >= sizeof(tick)) memcpy(&tick, payload, sizeof(tick));
+    bool ok = size >= sizeof(tick) && (type == kKeyframeMessage || (type == kDeltaMessage && tick == current + 1));
+    if (ok) {
+        if (type == kKeyframeMessage) {
+            if (current >= 0 && tick > current + 1) missed += tick - current - 1;
+            decoder.keyframe();
+        }
+        const unsigned char* p = payload + sizeof(tick);
+        ok = decoder.decode(p, payload + size, carStates) && p == payload + size;
+    }
+    if (!ok) {
+        printf("Error: corrupt spectator stream after tick %lld\n", current);
+        disconnect();
+        buffer.clear();
+        readOffset = 0;
+        return false;
+    }
+    readOffset += 5 + size;
+    current = tick;
+    return true;
+}
+
+int SpectatorClient::queuedTicks() {
+    receive(false);
+    int count = 0;
+    size_t offset = readOffset;
+    std::uint32_t length;
+    while (buffer.size() - offset >= sizeof(length)) {
+        memcpy(&length, buffer.data() + offset, sizeof(length));
+        if (length == 0 || buffer.size() - offset - sizeof(length) < length) break;
+        offset += sizeof(length) + length;
+        ++count;
+    }
+    return count;
+}
+
+void SpectatorClient::apply(std::vector<Car>& target) const {
+    applyReplayStates(carStates, target);
+}
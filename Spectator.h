@@ -0,0 +1,161 @@
+#pragma once
+#include "Replay.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// -------------------- Spectator Stream --------------------
+// Live race state for local viewer processes over a Unix domain socket. The
+// ticks use the replay encoding (ReplayTickEncoder): each tick is encoded
+// once, as a residual from the previous two, and the same bytes are queued
+// for every spectator.
+//
+// Stream: one Hello message (tick rate, track path, car table), then Tick
+// messages. Every message is a uint32 length, a type byte and the payload;
+// a tick's payload is its int64 tick number and the encoded cars. Every
+// keyframeInterval ticks the prediction restarts (a keyframe), as in replays.
+//
+// Backpressure: the server never blocks on a spectator. Sends are
+// non-blocking and unsent messages wait in the spectator's queue. When the
+// queue holds more than queueLimit bytes the spectator is dropped to the next
+// keyframe: queued ticks it has not started receiving are discarded, later
+// ticks are skipped, and it resumes at a keyframe, which decodes without the
+// skipped ticks. New spectators also start at the next keyframe. A slow
+// viewer thus costs at most queueLimit bytes of memory and loses ticks
+// rather than falling further and further behind.
+
+// -------------------- SpectatorServer Class --------------------
+// Publishes a simulation's cars to every connected spectator, one publish()
+// per tick
+class SpectatorServer {
+public:
+    static const int kDefaultKeyframeInterval = 60;     // Ticks between keyframes (0.25 s at 240 Hz)
+    static const size_t kDefaultQueueLimit = 256 * 1024; // Unsent bytes before a spectator is dropped to a keyframe
+
+    SpectatorServer();
+    ~SpectatorServer();
+
+    SpectatorServer(const SpectatorServer&) = delete;
+    SpectatorServer& operator=(const SpectatorServer&) = delete;
+
+    // -------------------- Publishing --------------------
+    // Listens on 'socketPath' (a stale socket file there is replaced) for
+    // spectators of sim's cars; 'trackPath' is the track file the race uses
+    // (empty = built-in track). Returns false if the socket cannot be created.
+    bool open(const std::string& socketPath, const Simulation& sim, const std::string& trackPath,
+        float tickSeconds, int keyframeInterval = kDefaultKeyframeInterval,
+        size_t queueLimit = kDefaultQueueLimit);
+
+    // Accepts new spectators, encodes the current state of 'cars' as the
+    // next tick and sends what each spectator's socket takes without waiting
+    void publish(const std::vector<Car>& cars);
+
+    // Disconnects every spectator and removes the socket (also done by the destructor)
+    void close();
+
+    bool isOpen() const { return listenSocket >= 0; }
+
+    // -------------------- Statistics --------------------
+    int spectatorCount() const { return static_cast<int>(spectators.size()); }
+    long long ticks() const { return tickCount; }         // Ticks published
+    long long skipped() const { return skippedTicks; }    // Spectator ticks skipped while waiting for a keyframe
+    long long bytesSent() const { return sentBytes; }
+
+private:
+    typedef std::shared_ptr<const std::vector<unsigned char>> Message; // Shared by every queue
+
+    // One connected viewer
+    struct Spectator {
+        int socket;
+        std::deque<Message> queue;   // Messages not completely sent
+        size_t offset;               // Bytes of queue.front() already sent
+        size_t queuedBytes;          // Unsent bytes in 'queue'
+        bool synced;                 // Receiving every tick (false = waiting for a keyframe)
+    };
+
+    int listenSocket;
+    std::string path;
+    int carCount;
+    int keyframeInterval;
+    size_t queueLimit;
+    long long tickCount;
+    long long skippedTicks;
+    long long sentBytes;
+    Message hello;                   // Sent to every new spectator
+    ReplayTickEncoder encoder;
+    std::vector<Spectator> spectators;
+
+    void acceptSpectators();
+
+    // Appends 'message' to the spectator's queue
+    static void enqueue(Spectator& spectator, const Message& message);
+
+    // Sends queued bytes until the socket would block; false if the spectator disconnected
+    bool flush(Spectator& spectator);
+};
+
+// -------------------- SpectatorClient Class --------------------
+// Receives a spectator stream and decodes it tick by tick, with the same
+// interface as ReplayReader
+class SpectatorClient {
+public:
+    std::string trackPath;             // Track file of the race (empty = built-in)
+    float tickSeconds;                 // Simulated time per tick
+    std::vector<ReplayCarInfo> cars;   // Names and colors, in car order
+
+    SpectatorClient();
+    ~SpectatorClient();
+
+    SpectatorClient(const SpectatorClient&) = delete;
+    SpectatorClient& operator=(const SpectatorClient&) = delete;
+
+    // -------------------- Connection --------------------
+    // Connects to a SpectatorServer and waits for the stream header and the
+    // first keyframe; returns false (printing the reason) on failure
+    bool connect(const std::string& socketPath);
+
+    // Loads the race's track into an empty Simulation and adds its cars
+    bool setup(Simulation& sim) const;
+
+    // False once the server closed the stream or sent corrupt data
+    bool connected() const { return socket >= 0; }
+
+    // -------------------- Playback --------------------
+    // Decodes the next received tick; false if none has arrived yet
+    bool next();
+
+    // Complete ticks received but not decoded yet
+    int queuedTicks();
+
+    long long tick() const { return current; }                  // Server tick held in states()
+    long long ticksMissed() const { return missed; }            // Ticks skipped by the server (drop-to-keyframe)
+
+    // Car states of the current tick
+    const std::vector<ReplayCarState>& states() const { return carStates; }
+
+    // Writes the current tick into the cars' replayed fields
+    void apply(std::vector<Car>& cars) const;
+
+private:
+    int socket;
+    std::vector<unsigned char> buffer; // Received bytes; complete messages start at 'readOffset'
+    size_t readOffset;
+    ReplayTickDecoder decoder;
+    std::vector<ReplayCarState> carStates;
+    long long current;                 // Decoded tick, -1 before the first
+    long long missed;
+
+    // Reads what the socket has (waiting for at least one byte if 'wait');
+    // false when the connection is closed
+    bool receive(bool wait);
+
+    // Complete message at 'readOffset': type and payload; false if none is buffered
+    bool peekMessage(unsigned char& type, const unsigned char*& payload, size_t& size) const;
+
+    // Decodes the tick message at 'readOffset' and consumes it
+    bool decodeMessage(const unsigned char* payload, size_t size, unsigned char type);
+
+    void disconnect();
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// -------------------- SpscRing Class --------------------
+// Fixed-capacity lock-free queue for exactly one producer thread and one
+// consumer thread. Neither side ever blocks or allocates: tryPush() fails
+// when the ring is full and tryPop() when it is empty.
+//
+// 'tail' is written only by the producer and 'head' only by the consumer;
+// each publishes its slot with a release store that the other side reads
+// with an acquire load. Both counters sit on their own cache line, and each
+// side keeps a private copy of the other's counter that it refreshes only
+// when the ring looks full (or empty), so in steady state a push or pop
+// touches no cache line the other thread is writing.
+template <class T>
+class SpscRing {
+public:
+    // -------------------- Constructor --------------------
+    // Capacity is rounded up to a power of two (at least 2)
+    explicit SpscRing(size_t capacity)
+        : head(0), tail(0), cachedHead(0), cachedTail(0)
+    {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return slots.size(); }
+
+    // -------------------- Producer --------------------
+    // Appends 'item'; false (and nothing written) if the ring is full
+    bool tryPush(const T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == slots.size()) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == slots.size()) return false;
+        }
+        slots[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // -------------------- Consumer --------------------
+    // Removes the oldest item into 'item'; false if the ring is empty
+    bool tryPop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return false;
+        }
+        item = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> slots;
+    size_t mask;                              // slots.size() - 1
+
+    alignas(64) std::atomic<size_t> head;     // Next slot to read (written by the consumer)
+    alignas(64) std::atomic<size_t> tail;     // Next slot to write (written by the producer)
+    alignas(64) size_t cachedHead;            // Producer's copy of head
+    alignas(64) size_t cachedTail;            // Consumer's copy of tail
+};
@@ -0,0 +1,65 @@
+// Standings.cpp : incrementally maintained race order.
+// Part of the GL-free simulation core.
+
+#include "Standings.h"
+#include <algorithm>
+
+// -------------------- Constructor --------------------
+Standings::Standings()
+{
+}
+
+// -------------------- Update --------------------
+// Insertion pass over the previous order: each car moves up past the cars it
+// has overtaken since the last update, one adjacent swap at a time
+int Standings::update(int carCount, const float* progressOf, std::vector<Overtake>* overtakes) {
+    bool rebuild = static_cast<int>(order.size()) != carCount;
+    if (!rebuild) {
+        // A heavily shuffled order (e.g. after restoring a snapshot) is re-sorted
+        // in one go instead of with adjacent swaps
+        int descents = 0;
+        for (int pos = 1; pos < carCount; ++pos)
+            if (ranksAhead(progressOf[order[pos]], order[pos], progressOf[order[pos - 1]], order[pos - 1])) ++descents;
+        rebuild = descents > carCount / 8 + 8;
+    }
+
+    if (rebuild) {
+        // New field or shuffled order: rank from scratch
+        order.resize(carCount);
+        for (int car = 0; car < carCount; ++car) order[car] = car;
+        std::sort(order.begin(), order.end(), [progressOf](int a, int b) {
+            return ranksAhead(progressOf[a], a, progressOf[b], b);
+        });
+        progress.resize(carCount);
+        positionOfCar.resize(carCount);
+        for (int pos = 0; pos < carCount; ++pos) {
+            progress[pos] = progressOf[order[pos]];
+            positionOfCar[order[pos]] = pos;
+        }
+        return 0;
+    }
+
+    for (int pos = 0; pos < carCount; ++pos)
+        progress[pos] = progressOf[order[pos]];
+
+    int swaps = 0;
+    for (int pos = 1; pos < carCount; ++pos) {
+        int car = order[pos];
+        float key = progress[pos];
+        int p = pos;
+        while (p > 0 && ranksAhead(key, car, progress[p - 1], order[p - 1])) {
+            if (overtakes) overtakes->push_back({ car, order[p - 1], p - 1 });
+            order[p] = order[p - 1];
+            progress[p] = progress[p - 1];
+            positionOfCar[order[p]] = p;
+            --p;
+            ++swaps;
+        }
+        if (p != pos) {
+            order[p] = car;
+            progress[p] = key;
+            positionOfCar[car] = p;
+        }
+    }
+    return swaps;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+
+// -------------------- Standings Class --------------------
+// Race order of all cars, kept up to date incrementally.
+// Cars are ranked by race progress (laps plus fraction of the current lap),
+// highest first; equal progress is broken by car index so the order is
+// deterministic.
+//
+// Between two ticks a car can only pass the few cars right next to it, so
+// update() walks the order once and moves each car that gained on the car
+// ahead of it with adjacent swaps - one swap per overtake. A tick without
+// overtakes costs one O(N) comparison pass and no sorting or allocation. A
+// heavily shuffled order (a new field, a restored snapshot) is fully re-sorted.
+//
+// Queries:
+//   leader()        - O(1) car in first place
+//   positionOf(car) - O(1) 0-based position of a car
+//   carAt(pos)      - O(1) car holding a position; the first K give the top K
+class Standings {
+public:
+    // One adjacent swap: 'car' moved up past 'passed' into 'position'
+    struct Overtake {
+        int car, passed, position;
+    };
+
+    // -------------------- Constructor --------------------
+    Standings();
+
+    // -------------------- Update --------------------
+    // Refreshes the order with each car's race progress; returns the number
+    // of overtakes (adjacent swaps), and appends them to 'overtakes' if given.
+    // A different car count rebuilds the order (reported as no overtakes).
+    int update(int carCount, const float* progressOf, std::vector<Overtake>* overtakes = nullptr);
+
+    // -------------------- Queries --------------------
+    // Car in first place, or -1 if there are no cars
+    int leader() const { return order.empty() ? -1 : order[0]; }
+
+    // 0-based position of 'car' (0 = leader)
+    int positionOf(int car) const { return positionOfCar[car]; }
+
+    // Car at 0-based 'position'
+    int carAt(int position) const { return order[position]; }
+
+    // Number of ranked cars
+    int size() const { return static_cast<int>(order.size()); }
+
+private:
+    std::vector<int> order;          // Car ids from first to last place
+    std::vector<float> progress;     // Race progress of order[i] (parallel to order)
+    std::vector<int> positionOfCar;  // Position of each car in 'order'
+
+    // True if car a with progress pa ranks ahead of car b with progress pb
+    static bool ranksAhead(float pa, int a, float pb, int b) {
+        return pa > pb || (pa == pb && a < b);
+    }
+};
@@ -0,0 +1,224 @@
+#include "stdafx.h"
+#include "TextRenderer.h"
+#include "Profiler.h"
+#include <GL/glut.h>
+#include <cmath>
+
+// Glyph cells are sized for the 18-point GLUT fonts: 28 pixels tall with the
+// baseline kBaseline pixels up, which leaves room for the ascent and descenders
+static const int kCellHeight = 28;
+
+// -------------------- Constructor --------------------
+TextRenderer::TextRenderer(void* font, float screenWidth, float screenHeight)
+    : screenWidth(screenWidth), screenHeight(screenHeight), enabled(true), font(font),
+    atlasTexture(0), atlasFailed(false), cellWidth(0), cellHeight(kCellHeight),
+    atlasWidth(0), atlasHeight(0)
+{
+    for (int i = 0; i < kGlyphCount; ++i) {
+        advance[i] = 0;
+        blank[i] = false;
+    }
+    for (int i = 0; i < 16; ++i) modelview[i] = projection[i] = (i % 5 == 0) ? 1.0 : 0.0;
+    viewport[0] = viewport[1] = 0;
+    viewport[2] = static_cast<GLint>(screenWidth);
+    viewport[3] = static_cast<GLint>(screenHeight);
+}
+
+// -------------------- Frame Setup --------------------
+void TextRenderer::prepare() {
+    if (enabled && !atlasTexture && !atlasFailed) buildAtlas();
+}
+
+void TextRenderer::captureTransform() {
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+}
+
+// -------------------- Atlas Building --------------------
+// The glyphs are drawn with glutBitmapCharacter into the lower-left corner of
+// the back buffer, read back and uploaded as an alpha texture, so the atlas
+// holds exactly the pixels GLUT would have drawn. The caller clears the back
+// buffer afterwards (see prepare()).
+void TextRenderer::buildAtlas() {
+    int maxAdvance = 0;
+    for (int i = 0; i < kGlyphCount; ++i) {
+        advance[i] = glutBitmapWidth(font, kFirstGlyph + i);
+        if (advance[i] > maxAdvance) maxAdvance = advance[i];
+    }
+    cellWidth = maxAdvance + 2 * kCellPad;
+
+    int rows = (kGlyphCount + kAtlasColumns - 1) / kAtlasColumns;
+    int usedWidth = kAtlasColumns * cellWidth;
+    int usedHeight = rows * cellHeight;
+    if (glutGet(GLUT_WINDOW_WIDTH) < usedWidth || glutGet(GLUT_WINDOW_HEIGHT) < usedHeight) {
+        atlasFailed = true;
+        return;
+    }
+    atlasWidth = 1;
+    while (atlasWidth < usedWidth) atlasWidth *= 2;
+    atlasHeight = 1;
+    while (atlasHeight < usedHeight) atlasHeight *= 2;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_VIEWPORT_BIT | GL_CURRENT_BIT | GL_TEXTURE_BIT);
+    glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluOrtho2D(0, usedWidth, 0, usedHeight);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glViewport(0, 0, usedWidth, usedHeight);
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_BLEND);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    for (int i = 0; i < kGlyphCount; ++i) {
+        int column = i % kAtlasColumns, row = i / kAtlasColumns;
+        // A quarter pixel in, so rounding cannot move a glyph into the neighbouring cell
+        glRasterPos2f(column * cellWidth + kCellPad + 0.25f, row * cellHeight + kBaseline + 0.25f);
+        glutBitmapCharacter(font, kFirstGlyph + i);
+    }
+
+    // The white-on-black coverage becomes the alpha channel
+    std::vector<GLubyte> coverage(static_cast<size_t>(atlasWidth) * atlasHeight, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glPixelStorei(GL_PACK_ROW_LENGTH, atlasWidth);
+    glPixelStorei(GL_PACK_SKIP_ROWS, 0);
+    glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+    glReadPixels(0, 0, usedWidth, usedHeight, GL_RED, GL_UNSIGNED_BYTE, coverage.data());
+
+    // Glyphs without pixels (the space) get no quads
+    for (int i = 0; i < kGlyphCount; ++i) {
+        int x0 = (i % kAtlasColumns) * cellWidth, y0 = (i / kAtlasColumns) * cellHeight;
+        blank[i] = true;
+        for (int y = y0; y < y0 + cellHeight && blank[i]; ++y)
+            for (int x = x0; x < x0 + cellWidth && blank[i]; ++x)
+                blank[i] = coverage[static_cast<size_t>(y) * atlasWidth + x] == 0;
+    }
+
+    glGenTextures(1, &atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, atlasWidth, atlasHeight, 0, GL_ALPHA, GL_UNSIGNED_BYTE, coverage.data());
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopClientAttrib();
+    glPopAttrib();
+}
+
+// -------------------- Queueing --------------------
+void TextRenderer::addWorldText(float x, float y, const std::string& text, float r, float g, float b) {
+    GLdouble winX, winY, winZ;
+    if (!gluProject(x, y, 0.0, modelview, projection, viewport, &winX, &winY, &winZ)) return;
+    addPixelText(static_cast<float>(winX), static_cast<float>(winY), text, r, g, b);
+}
+
+void TextRenderer::addScreenText(float x, float y, const std::string& text, float r, float g, float b) {
+    float pixelX = viewport[0] + x * viewport[2] / screenWidth;
+    float pixelY = viewport[1] + y * viewport[3] / screenHeight;
+    addPixelText(pixelX, pixelY, text, r, g, b);
+}
+
+// Each printable character becomes one quad covering its whole atlas cell;
+// the pen moves by the glyph's GLUT advance, as glutBitmapCharacter does
+void TextRenderer::addPixelText(float x, float y, const std::string& text, float r, float g, float b) {
+    if (!enabled) return;
+    if (!atlasTexture) {
+        pending.push_back({ x, y, r, g, b, text });
+        return;
+    }
+
+    GLubyte color[4] = {
+        static_cast<GLubyte>(r * 255.0f + 0.5f),
+        static_cast<GLubyte>(g * 255.0f + 0.5f),
+        static_cast<GLubyte>(b * 255.0f + 0.5f),
+        255
+    };
+    // Bitmaps start at the pixel containing the raster position
+    float penX = std::floor(x);
+    float penY = std::floor(y);
+    float du = static_cast<float>(cellWidth) / atlasWidth;
+    float dv = static_cast<float>(cellHeight) / atlasHeight;
+
+    for (char c : text) {
+        int glyph = static_cast<unsigned char>(c) - kFirstGlyph;
+        if (glyph < 0 || glyph >= kGlyphCount) continue;
+        if (!blank[glyph]) {
+            float x0 = penX - kCellPad, y0 = penY - kBaseline;
+            float x1 = x0 + cellWidth, y1 = y0 + cellHeight;
+            float u0 = (glyph % kAtlasColumns) * du, v0 = (glyph / kAtlasColumns) * dv;
+            float u1 = u0 + du, v1 = v0 + dv;
+
+            GLfloat quad[8] = { x0, y0, x1, y0, x1, y1, x0, y1 };
+            GLfloat uv[8] = { u0, v0, u1, v0, u1, v1, u0, v1 };
+            vertices.insert(vertices.end(), quad, quad + 8);
+            texCoords.insert(texCoords.end(), uv, uv + 8);
+            for (int v = 0; v < 4; ++v) colors.insert(colors.end(), color, color + 4);
+        }
+        penX += advance[glyph];
+    }
+}
+
+// -------------------- Drawing --------------------
+// Draws in window pixel coordinates, leaving the caller's matrices and state intact
+void TextRenderer::flush() {
+    PROFILE_SCOPE("Text::flush");
+    if (vertices.empty() && pending.empty()) return;
+
+    GLint window[4];
+    glGetIntegerv(GL_VIEWPORT, window);
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_TEXTURE_BIT);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluOrtho2D(window[0], window[0] + window[2], window[1], window[1] + window[3]);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    if (!vertices.empty()) {
+        glEnable(GL_TEXTURE_2D);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+        glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(2, GL_FLOAT, 0, vertices.data());
+        glTexCoordPointer(2, GL_FLOAT, 0, texCoords.data());
+        glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors.data());
+        glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(vertices.size() / 2));
+        glPopClientAttrib();
+    }
+
+    // Fallback: plain GLUT bitmap text
+    for (const auto& label : pending) {
+        glColor3f(label.r, label.g, label.b);
+        glRasterPos2f(label.x, label.y);
+        for (char c : label.text)
+            glutBitmapCharacter(font, c);
+    }
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopAttrib();
+
+    vertices.clear();
+    texCoords.clear();
+    colors.clear();
+    pending.clear();
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <GL/glut.h>
+#include <string>
+#include <vector>
+
+// -------------------- TextRenderer Class --------------------
+// Batched bitmap text for the HUD and car labels.
+// The printable ASCII glyphs of a GLUT bitmap font are rendered once into a
+// glyph atlas texture. Text is then queued as textured quads in window pixel
+// coordinates and drawn with a single glDrawArrays per flush(), instead of a
+// glutBitmapCharacter call (and a raster position update) per character.
+// Labels look exactly like the GLUT text they replace: same font, same pixel
+// size at any zoom, anchored at the same raster position.
+//
+// If the atlas cannot be built (window smaller than the atlas), queued text
+// falls back to glutBitmapCharacter.
+class TextRenderer {
+public:
+    float screenWidth;   // Width of the virtual screen space used by addScreenText
+    float screenHeight;  // Height of the virtual screen space used by addScreenText
+    bool enabled;        // False drops all text (GLUT fonts need glutInit, which offscreen rendering skips)
+
+    // -------------------- Constructor --------------------
+    // 'font' is a GLUT bitmap font; screen text uses a screenWidth x screenHeight space
+    explicit TextRenderer(void* font = GLUT_BITMAP_HELVETICA_18, float screenWidth = 900.0f, float screenHeight = 700.0f);
+
+    // -------------------- Frame Setup --------------------
+    // Builds the glyph atlas on first use. Call at the start of a frame, before
+    // clearing: building draws into the back buffer.
+    void prepare();
+
+    // Records the current modelview/projection/viewport; addWorldText projects with it
+    void captureTransform();
+
+    // -------------------- Queueing --------------------
+    // Queues text whose baseline starts at world position (x, y)
+    void addWorldText(float x, float y, const std::string& text, float r, float g, float b);
+
+    // Queues text whose baseline starts at (x, y) of the virtual screen space
+    void addScreenText(float x, float y, const std::string& text, float r, float g, float b);
+
+    // Draws everything queued since the last flush() with one call
+    void flush();
+
+private:
+    // -------------------- Glyph Atlas --------------------
+    static const int kFirstGlyph = 32;    // ' '
+    static const int kGlyphCount = 95;    // ' ' .. '~'
+    static const int kAtlasColumns = 16;  // Glyph cells per atlas row
+    static const int kCellPad = 2;        // Free pixels left of the pen position in each cell
+    static const int kBaseline = 6;       // Pen baseline height inside a cell (room for descenders)
+
+    void* font;              // GLUT bitmap font
+    GLuint atlasTexture;     // Alpha texture with all glyphs (0 = not built)
+    bool atlasFailed;        // Atlas could not be built: use GLUT directly
+    int cellWidth;           // Atlas cell size in pixels
+    int cellHeight;
+    int atlasWidth;          // Atlas texture size (powers of two)
+    int atlasHeight;
+    int advance[kGlyphCount]; // Pen advance of each glyph in pixels
+    bool blank[kGlyphCount];  // Glyph has no pixels (no quad needed)
+
+    // -------------------- Transform --------------------
+    GLdouble modelview[16];  // Captured by captureTransform()
+    GLdouble projection[16];
+    GLint viewport[4];
+
+    // -------------------- Queued Geometry --------------------
+    std::vector<GLfloat> vertices;    // x, y per vertex (window pixels)
+    std::vector<GLfloat> texCoords;   // u, v per vertex
+    std::vector<GLubyte> colors;      // r, g, b, a per vertex
+
+    // Fallback queue (no atlas)
+    struct PendingText {
+        float x, y;
+        float r, g, b;
+        std::string text;
+    };
+    std::vector<PendingText> pending;
+
+    // Renders the glyphs with GLUT and copies them into the atlas texture
+    void buildAtlas();
+
+    // Queues text with its baseline at window pixel (x, y)
+    void addPixelText(float x, float y, const std::string& text, float r, float g, float b);
+};
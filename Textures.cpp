@@ -1,50 +1,75 @@
 #include "stdafx.h"
 #include "Textures.h"
+#include "Image.h"
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+
+#ifndef GL_BGR_EXT
+#define GL_BGR_EXT 0x80E0   // EXT_bgra / OpenGL 1.2; missing from the Windows GL 1.1 headers
+#endif
+#ifndef GL_BGRA_EXT
+#define GL_BGRA_EXT 0x80E1
+#endif
 
 // -------------------- Global Texture IDs --------------------
 // OpenGL texture IDs for cars and wheels, initialized to 0 (not loaded yet)
 GLuint g_carTex = 0;    // Main car texture
 GLuint g_wheelTex = 0;  // Wheel texture
 
-// -------------------- Custom BMP Loader --------------------
-// Simple 24-bit BMP loader (no color palette support).
-// Loads a BMP file from disk, converts BGR to RGB, and uploads as an OpenGL texture.
-// Returns the generated OpenGL texture ID, or 0 on failure.
-GLuint loadBMP_custom(const char* imagepath) {
-    // Open file in binary mode
-    FILE* file = fopen(imagepath, "rb");
-    if (!file) return 0;  // Failed to open file
-
-    // Read BMP header (54 bytes)
-    unsigned char header[54];
-    if (fread(header, 1, 54, file) != 54) { fclose(file); return 0; }
-
-    // Verify BMP signature ('B' 'M')
-    if (header[0] != 'B' || header[1] != 'M') { fclose(file); return 0; }
-
-    // Extract image metadata from header
-    unsigned int dataPos = *(int*)&(header[0x0A]);  // Start of pixel data
-    unsigned int imageSize = *(int*)&(header[0x22]);  // Size of raw image data
-    unsigned int width = *(int*)&(header[0x12]);  // Image width in pixels
-    unsigned int height = *(int*)&(header[0x16]);  // Image height in pixels
-
-    // Default values if not set in BMP header
-    if (imageSize == 0) dataPos = width * height * 3;
-    if (dataPos == 0) dataPos = 54;
-
-    // Allocate buffer and read pixel data
-    unsigned char* data = (unsigned char*)malloc(imageSize);
-    fseek(file, dataPos, SEEK_SET);
-    fread(data, 1, imageSize, file);
-    fclose(file);
-
-    // BMP stores pixels in BGR order; convert to RGB
-    for (unsigned int i = 0; i < imageSize; i += 3) {
-        unsigned char tmp = data[i];
-        data[i] = data[i + 2];
-        data[i + 2] = tmp;
+TextureManager g_textures;
+
+// -------------------- Constructor --------------------
+TextureManager::TextureManager()
+    : loader(2), bgrSupport(-1)
+{
+}
+
+// -------------------- BGR Support --------------------
+// GL 1.2 made BGR core; older implementations may still offer EXT_bgra
+bool TextureManager::supportsBGR() {
+    if (bgrSupport < 0) {
+        const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+        const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+        int major = 0, minor = 0;
+        if (version) sscanf(version, "%d.%d", &major, &minor);
+        bool core = major > 1 || (major == 1 && minor >= 2);
+        bool supported = core || (extensions && strstr(extensions, "GL_EXT_bgra"));
+        if (!version) return false; // No context yet: ask again next time
+        bgrSupport = supported ? 1 : 0;
+    }
+    return bgrSupport == 1;
+}
+
+// -------------------- Load --------------------
+GLuint TextureManager::load(const std::string& path) {
+    auto cached = cache.find(path);
+    if (cached != cache.end()) {
+        ++counters.cacheHits;
+        return cached->second;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Image image;
+    bool decoded = image.loadBMP(path);
+    counters.decodeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    GLuint textureID = decoded ? upload(image) : 0;
+    if (!textureID) ++counters.failed;
+    cache[path] = textureID;
+    return textureID;
+}
+
+// -------------------- Upload --------------------
+GLuint TextureManager::upload(Image& image) {
+    if (!image.pixels) return 0;
+
+    auto start = std::chrono::steady_clock::now();
+    GLenum format = image.channels == 4 ? GL_BGRA_EXT : GL_BGR_EXT;
+    if (!supportsBGR()) {
+        image.swapRedBlue();
+        format = image.channels == 4 ? GL_RGBA : GL_RGB;
     }
 
     // Generate and bind OpenGL texture
@@ -56,12 +81,70 @@ GLuint loadBMP_custom(const char* imagepath) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    // Upload pixel data to GPU
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-
-    // Free CPU-side memory
-    free(data);
+    // Upload pixel data to GPU; BMP rows are padded to 4 bytes like GL's default unpack alignment
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, image.channels == 4 ? GL_RGBA : GL_RGB, image.width, image.height, 0,
+        format, GL_UNSIGNED_BYTE, image.pixels);
+    glBindTexture(GL_TEXTURE_2D, 0);
 
-    // Return OpenGL texture ID
+    ++counters.loaded;
+    counters.bytes += image.byteSize();
+    counters.uploadSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
     return textureID;
 }
+
+// -------------------- Asynchronous Loading --------------------
+void TextureManager::request(const std::string& path) {
+    if (cache.count(path) || !requested.insert(path).second) return;
+    loader.request(path);
+}
+
+// Failed decodes resolve to 0 like failed synchronous loads
+int TextureManager::pumpUploads(double budgetSeconds) {
+    if (requested.empty()) return 0;
+    loader.takeFinished(decoded);
+
+    auto start = std::chrono::steady_clock::now();
+    int resolved = 0;
+    size_t next = 0;
+    for (; next < decoded.size(); ++next) {
+        if (resolved > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= budgetSeconds)
+            break;
+        DecodedImage& done = decoded[next];
+        counters.decodeSeconds += done.seconds;
+        requested.erase(done.path);
+        ++resolved;
+        if (cache.count(done.path)) continue; // Loaded synchronously in the meantime
+
+        GLuint textureID = done.image ? upload(*done.image) : 0;
+        if (!textureID) ++counters.failed;
+        cache[done.path] = textureID;
+    }
+    decoded.erase(decoded.begin(), decoded.begin() + next);
+    return resolved;
+}
+
+GLuint TextureManager::get(const std::string& path) const {
+    auto cached = cache.find(path);
+    return cached == cache.end() ? 0 : cached->second;
+}
+
+// -------------------- Clear --------------------
+void TextureManager::clear() {
+    for (const auto& entry : cache)
+        if (entry.second) glDeleteTextures(1, &entry.second);
+    cache.clear();
+}
+
+// -------------------- Statistics --------------------
+void TextureManager::printStats() const {
+    printf("Textures: %d loaded (%.1f KB), %d cache hits, %d missing; decode %.2f ms, upload %.2f ms\n",
+        counters.loaded, counters.bytes / 1024.0, counters.cacheHits, counters.failed,
+        counters.decodeSeconds * 1000.0, counters.uploadSeconds * 1000.0);
+}
+
+// -------------------- Custom BMP Loader --------------------
+// Kept for existing callers; all loads go through the shared cache
+GLuint loadBMP_custom(const char* imagepath) {
+    return g_textures.load(imagepath);
+}
@@ -1,8 +1,88 @@
 #pragma once
+#include "AssetLoader.h"
 #include <GL/glut.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Image;
+
+// -------------------- TextureManager Class --------------------
+// Loads BMP files into OpenGL textures, once per path.
+// Files are memory-mapped and decoded by Image (GL-free); bottom-up BMP rows
+// already match GL's row order and 4-byte unpack alignment, so they are
+// uploaded straight from the mapping as GL_BGR(A) with no conversion pass.
+// Only on GL implementations without BGR upload (GL 1.1 without EXT_bgra)
+// are the channels swapped first. Every load is timed for the stats.
+//
+// Textures can also be loaded asynchronously: request() only queues the file
+// for an AssetLoader thread (no GL context needed, so it can run before the
+// window exists), and pumpUploads(), called on the GL thread once per frame,
+// uploads whatever has been decoded. Until then get() returns 0 and callers
+// draw their fallback colours.
+class TextureManager {
+public:
+    // -------------------- Statistics --------------------
+    struct Stats {
+        int loaded = 0;            // Files decoded and uploaded
+        int cacheHits = 0;         // Requests answered from the cache
+        int failed = 0;            // Files missing or unsupported
+        size_t bytes = 0;          // Pixel bytes uploaded
+        double decodeSeconds = 0;  // Time spent mapping and decoding (on any thread)
+        double uploadSeconds = 0;  // Time spent in glTexImage2D
+    };
+
+    TextureManager();
+
+    // -------------------- Loading --------------------
+    // Returns the texture for 'path', loading it on first use; 0 if it cannot
+    // be loaded (failures are cached too, so missing files are tried once)
+    GLuint load(const std::string& path);
+
+    // Uploads a decoded image as a new linear-filtered texture; needs a GL context
+    GLuint upload(Image& image);
+
+    // -------------------- Asynchronous Loading --------------------
+    // Queues 'path' for reading and decoding on a loader thread; paths already
+    // loaded or queued are ignored
+    void request(const std::string& path);
+
+    // Uploads decoded requests until 'budgetSeconds' of upload time is spent
+    // (at least one); needs a GL context. Returns the number of paths resolved.
+    int pumpUploads(double budgetSeconds);
+
+    // Texture for a loaded path, 0 while it is loading or if it failed; no
+    // loading and no cache-hit count
+    GLuint get(const std::string& path) const;
+
+    // True while requested paths are decoding or waiting for upload
+    bool loading() const { return !requested.empty(); }
+
+    // Deletes every cached texture
+    void clear();
+
+    // -------------------- Statistics --------------------
+    const Stats& stats() const { return counters; }
+    void printStats() const;
+
+private:
+    std::unordered_map<std::string, GLuint> cache; // Path -> texture (0 = failed)
+    Stats counters;
+    AssetLoader loader;                            // Decode threads for request()
+    std::unordered_set<std::string> requested;     // Requested paths not in 'cache' yet
+    std::vector<DecodedImage> decoded;             // Taken from 'loader', waiting for upload
+    int bgrSupport;                                // -1 = not checked yet, else 0/1
+
+    // True if the current context accepts GL_BGR/GL_BGRA pixel data
+    bool supportsBGR();
+};
+
+// Shared texture manager of the GLUT application
+extern TextureManager g_textures;
 
 // -------------------- Custom BMP Loader --------------------
-// Loads a 24-bit uncompressed BMP image from disk and creates an OpenGL texture.
+// Loads a 24- or 32-bit uncompressed BMP image through g_textures.
 // The function returns the OpenGL texture ID on success, or 0 if the file could
 // not be loaded or is invalid. This loader does not support BMP files with color palettes.
 GLuint loadBMP_custom(const char* imagepath);
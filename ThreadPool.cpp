@@ -0,0 +1,137 @@
+// ThreadPool.cpp : worker pool for data-parallel loops and work-stealing tasks.
+// Part of the GL-free simulation core.
+
+#include "ThreadPool.h"
+
+// -------------------- Constructor --------------------
+// Starts threadCount - 1 workers; the caller is participant 0
+ThreadPool::ThreadPool(int threadCount)
+    : job(nullptr), pending(0), generation(0), stopping(false)
+{
+    int participants = threadCount < 1 ? 1 : threadCount;
+    for (int p = 0; p < participants; ++p)
+        queues.emplace_back(new TaskQueue());
+    for (int p = 1; p < participants; ++p)
+        workers.emplace_back(&ThreadPool::workerLoop, this, p);
+}
+
+// -------------------- Destructor --------------------
+// Wakes all workers and joins them
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+// -------------------- Run On All Participants --------------------
+// Publishes 'work' to every worker, runs it on the calling thread as
+// participant 0 and returns once all workers have finished it
+void ThreadPool::runOnAll(const std::function<void(int)>& work) {
+    if (workers.empty()) {
+        work(0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &work;
+        pending = static_cast<int>(workers.size());
+        ++generation;
+    }
+    jobReady.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    jobDone.wait(lock, [this] { return pending == 0; });
+    job = nullptr;
+}
+
+// -------------------- Worker Loop --------------------
+// Sleeps until a new generation is published, runs the job, reports back
+void ThreadPool::workerLoop(int participant) {
+    unsigned long long seen = 0;
+    for (;;) {
+        const std::function<void(int)>* work;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobReady.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            work = job;
+        }
+
+        (*work)(participant);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --pending;
+        }
+        jobDone.notify_one();
+    }
+}
+
+// -------------------- Range Partition --------------------
+// Contiguous, balanced split that depends only on count and thread count
+void ThreadPool::rangeFor(int participant, int count, int& begin, int& end) const {
+    long long participants = threadCount();
+    begin = static_cast<int>(count * participant / participants);
+    end = static_cast<int>(count * (participant + 1) / participants);
+}
+
+// -------------------- Parallel Loop --------------------
+void ThreadPool::parallelFor(int count, const std::function<void(int, int)>& body) {
+    if (count <= 0) return;
+    if (workers.empty()) {
+        body(0, count);
+        return;
+    }
+
+    runOnAll([this, count, &body](int participant) {
+        int begin, end;
+        rangeFor(participant, count, begin, end);
+        if (begin < end) body(begin, end);
+    });
+}
+
+// -------------------- Next Task --------------------
+// Pops from the back of the participant's own deque (most recently dealt, still
+// warm), otherwise steals from the front of the other deques in turn
+int ThreadPool::nextTask(int participant) {
+    int participants = threadCount();
+    for (int k = 0; k < participants; ++k) {
+        TaskQueue& queue = *queues[(participant + k) % participants];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+
+        int task;
+        if (k == 0) { task = queue.tasks.back(); queue.tasks.pop_back(); }
+        else { task = queue.tasks.front(); queue.tasks.pop_front(); }
+        return task;
+    }
+    return -1;
+}
+
+// -------------------- Work-Stealing Tasks --------------------
+void ThreadPool::runTasks(int taskCount, const std::function<void(int, int)>& body) {
+    if (taskCount <= 0) return;
+
+    // Deal contiguous blocks of task indices to the participants' deques
+    int participants = threadCount();
+    for (int p = 0; p < participants; ++p) {
+        int begin, end;
+        rangeFor(p, taskCount, begin, end);
+        std::lock_guard<std::mutex> lock(queues[p]->mutex);
+        for (int t = end - 1; t >= begin; --t)
+            queues[p]->tasks.push_back(t); // Back of the deque = lowest index of the block
+    }
+
+    runOnAll([this, &body](int participant) {
+        for (int task = nextTask(participant); task >= 0; task = nextTask(participant))
+            body(task, participant);
+    });
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// -------------------- ThreadPool Class --------------------
+// Fixed set of worker threads shared by the simulation's parallel loops.
+//
+// parallelFor splits [0, count) into one contiguous range per participant
+// (the calling thread runs the first range) and returns once every range is
+// done. Ranges depend only on count and the thread count, so a body that writes
+// nothing but its own indices produces the same result on any pool size.
+//
+// runTasks is for independent jobs of uneven length (e.g. whole races): task
+// indices are dealt into one deque per participant, each participant pops from
+// the back of its own deque and, once empty, steals from the front of the
+// others, so no thread idles while work remains anywhere.
+class ThreadPool {
+public:
+    // -------------------- Constructor / Destructor --------------------
+    // 'threadCount' is the total number of participants including the caller;
+    // values below 1 are treated as 1 (no worker threads, everything inline)
+    explicit ThreadPool(int threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of participants (workers + calling thread)
+    int threadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+    // -------------------- Parallel Loop --------------------
+    // Runs body(begin, end) over disjoint ranges covering [0, count) and waits
+    void parallelFor(int count, const std::function<void(int, int)>& body);
+
+    // -------------------- Work-Stealing Tasks --------------------
+    // Runs body(task, participant) once for every task in [0, taskCount) and waits.
+    // 'participant' (0..threadCount()-1) identifies the executing thread, e.g. to
+    // pick a per-thread accumulator.
+    void runTasks(int taskCount, const std::function<void(int, int)>& body);
+
+private:
+    std::vector<std::thread> workers;   // Worker threads (participants 1..N-1)
+
+    // -------------------- Job State --------------------
+    // Guarded by 'mutex'; a new job is published by bumping 'generation'
+    std::mutex mutex;
+    std::condition_variable jobReady;   // Signals workers that a job was published
+    std::condition_variable jobDone;    // Signals the caller that a worker finished
+    const std::function<void(int)>* job; // Current job, called with the participant index
+    int pending;                        // Workers still running the current job
+    unsigned long long generation;      // Incremented for every published job
+    bool stopping;                      // Set by the destructor
+
+    // -------------------- Task Queues --------------------
+    // One deque of task indices per participant, used by runTasks
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+
+    // Runs job(participant) on every participant and waits for all of them
+    void runOnAll(const std::function<void(int)>& job);
+
+    // Worker thread main loop
+    void workerLoop(int participant);
+
+    // Range of iterations assigned to a participant
+    void rangeFor(int participant, int count, int& begin, int& end) const;
+
+    // Next task for a participant: own queue first, then steal; -1 when all are empty
+    int nextTask(int participant);
+};
@@ -1,167 +1,434 @@
-#include "stdafx.h"
+// Track.cpp : track geometry generation.
+// Part of the GL-free simulation core (no stdafx.h / GLUT include).
+// Texture loading and drawing live in TrackRenderer.cpp.
+
 #include "Track.h"
-#include "Textures.h" // Provides loadBMP_custom for texture loading
-#include <GL/glut.h>
+#include "MappedFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-// -------------------- Global Track Radii --------------------
-// These global variables are used elsewhere for track boundary checks, camera limits, etc.
-float g_trackRadiusX = 10.0f;
-float g_trackRadiusY = 5.0f;
-
-// -------------------- Texture Loading Helper --------------------
-// Loads a BMP texture file and returns the OpenGL texture ID
-// Returns 0 if the file is missing, allowing fallback rendering
-GLuint Track::loadTexture(const char* filename) {
-    return loadBMP_custom(filename);
+// -------------------- Geometry Storage --------------------
+void TrackGeometry::resize(int lanes, int pointsPerLane) {
+    laneCount = lanes;
+    pointCount = pointsPerLane;
+    size_t n = static_cast<size_t>(pointsPerLane);
+    points.resize(lanes * n);
+    laneOffsets.resize(lanes);
+    laneLengths.resize(lanes);
+    arc.resize(lanes * (n + 1));
+    tangent.resize(lanes * n);
+    heading.resize(lanes * n);
+    bucketSegment.resize(lanes * n);
 }
 
 // -------------------- Track Constructor --------------------
-// Initializes track geometry (elliptical lanes) and optional textures
-Track::Track()
-    : asphaltTextureID(0), grassTextureID(0), curbTextureID(0),
-    radiusX(10.0f), radiusY(5.0f)
-{
+std::shared_ptr<const TrackGeometry> Track::buildDefaultGeometry() {
     const int points = 200;           // Number of points used to approximate the track curve
-    const float radiusX_local = radiusX; // Horizontal radius of ellipse
-    const float radiusY_local = radiusY; // Vertical radius of ellipse
+    const float radiusX_local = 10.0f; // Horizontal radius of ellipse
+    const float radiusY_local = 5.0f;  // Vertical radius of ellipse
     const float laneSpacing = 1.5f;   // Lateral offset between lanes
 
+    std::shared_ptr<TrackGeometry> geo = std::make_shared<TrackGeometry>();
+    geo->resize(3, points);
+    geo->laneOffsets = { 0.0f, laneSpacing, -laneSpacing };
+
     // Generate points for 3 lanes along an elliptical track
+    Vector2* center = &geo->points[0];          // Center lane
+    Vector2* outer = &geo->points[points];      // Outer lane
+    Vector2* inner = &geo->points[2 * points];  // Inner lane
     for (int i = 0; i < points; ++i) {
         float t = (2.0f * M_PI * i) / points; // Angle in radians around the ellipse
         float x = radiusX_local * cos(t);     // X coordinate along ellipse
         float y = radiusY_local * sin(t);     // Y coordinate along ellipse
 
-        lane1.push_back(Vector2(x, y));          // Center lane
-        lane2.push_back(Vector2(x, y + laneSpacing)); // Outer lane
-        lane3.push_back(Vector2(x, y - laneSpacing)); // Inner lane
-    }
-
-    // Update global radii for camera or collision checks
-    g_trackRadiusX = radiusX_local;
-    g_trackRadiusY = radiusY_local;
-
-    // Attempt to load optional textures from executable folder
-    asphaltTextureID = loadTexture("asphalt.bmp"); // Main road surface
-    grassTextureID = loadTexture("grass.bmp");     // Background
-    curbTextureID = loadTexture("curb.bmp");       // Track edges/curbs
-}
-
-// -------------------- Draw Grass --------------------
-// Renders the track background, either textured or fallback plain green
-void Track::drawGrass() {
-    if (!grassTextureID) {
-        // Fallback plain grass
-        glDisable(GL_TEXTURE_2D);
-        glColor3f(0.85f, 0.95f, 0.85f);
-        glBegin(GL_QUADS);
-        glVertex2f(-40.0f, -40.0f);
-        glVertex2f(40.0f, -40.0f);
-        glVertex2f(40.0f, 40.0f);
-        glVertex2f(-40.0f, 40.0f);
-        glEnd();
-        glEnable(GL_TEXTURE_2D);
-        return;
-    }
-
-    // Optional: draw textured grass (currently using plain color)
-    glDisable(GL_TEXTURE_2D);
-    glColor3f(0.85f, 0.95f, 0.85f);
-    glBegin(GL_QUADS);
-    glVertex2f(-40.0f, -40.0f);
-    glVertex2f(40.0f, -40.0f);
-    glVertex2f(40.0f, 40.0f);
-    glVertex2f(-40.0f, 40.0f);
-    glEnd();
-    glEnable(GL_TEXTURE_2D);
-}
-
-// -------------------- Draw Asphalt --------------------
-// Draws the road surface using a texture if available, otherwise fallback plain gray
-void Track::drawAsphalt() {
-    if (asphaltTextureID) {
-        // Bind texture and draw quad strip between inner and outer lane boundaries
-        glBindTexture(GL_TEXTURE_2D, asphaltTextureID);
-        glColor3ub(255, 255, 255);
-        glBegin(GL_QUAD_STRIP);
-
-        int n = static_cast<int>(lane2.size());
-        for (int i = 0; i <= n; ++i) {
-            int idx = i % n;                  // Wrap around at the end
-            Vector2 pOuter = lane3[idx];      // Outer lane point
-            Vector2 pInner = lane1[idx];      // Inner lane point
-            float t = i / (float)n;           // Texture coordinate along track
-            glTexCoord2f(t * 4.0f, 0.0f); glVertex2f(pOuter.x, pOuter.y);
-            glTexCoord2f(t * 4.0f, 1.0f); glVertex2f(pInner.x, pInner.y);
+        center[i] = Vector2(x, y);
+        outer[i] = Vector2(x, y + laneSpacing);
+        inner[i] = Vector2(x, y - laneSpacing);
+    }
+    buildLaneTables(*geo);
+    return std::shared_ptr<const TrackGeometry>(geo);
+}
+
+// The built-in ellipse is generated once per process and shared by every
+// default-constructed Track
+std::shared_ptr<const TrackGeometry> Track::defaultGeometry() {
+    static const std::shared_ptr<const TrackGeometry> ellipse = buildDefaultGeometry();
+    return ellipse;
+}
+
+Track::Track()
+    : radiusX(10.0f), radiusY(5.0f)
+{
+    adopt(defaultGeometry(), radiusX, radiusY);
+}
+
+// Readers only ever see a complete geometry: it is filled before being published here
+void Track::adopt(std::shared_ptr<const TrackGeometry> geo, float extentX, float extentY) {
+    geometry = std::move(geo);
+    radiusX = extentX;
+    radiusY = extentY;
+}
+
+// -------------------- Arc-Length Tables --------------------
+// One pass per lane over its closed polyline; this is the only place where
+// segment lengths and headings are computed
+void Track::buildLaneTables(TrackGeometry& geo) {
+    int n = geo.pointCount;
+    for (int lane = 0; lane < geo.laneCount; ++lane) {
+        const Vector2* points = &geo.points[static_cast<size_t>(lane) * n];
+        float* arc = &geo.arc[static_cast<size_t>(lane) * (n + 1)];
+        Vector2* tangent = &geo.tangent[static_cast<size_t>(lane) * n];
+        float* heading = &geo.heading[static_cast<size_t>(lane) * n];
+        int* bucketSegment = &geo.bucketSegment[static_cast<size_t>(lane) * n];
+
+        arc[0] = 0.0f;
+        for (int i = 0; i < n; ++i) {
+            Vector2 segment = points[(i + 1) % n] - points[i];
+            float length = segment.length();
+            arc[i + 1] = arc[i] + length;
+            tangent[i] = length > 0.0f ? segment * (1.0f / length) : Vector2(1.0f, 0.0f);
+            heading[i] = atan2(tangent[i].y, tangent[i].x) * 180.0f / M_PI;
         }
-        glEnd();
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
-    else {
-        // Fallback plain road if texture missing
-        glDisable(GL_TEXTURE_2D);
-        glColor3f(0.2f, 0.2f, 0.2f);
-        glBegin(GL_QUAD_STRIP);
-
-        int n = static_cast<int>(lane2.size());
-        for (int i = 0; i <= n; ++i) {
-            int idx = i % n;
-            Vector2 pOuter = lane3[idx];
-            Vector2 pInner = lane1[idx];
-            glVertex2f(pOuter.x, pOuter.y);
-            glVertex2f(pInner.x, pInner.y);
+        float laneLength = arc[n];
+        geo.laneLengths[lane] = laneLength;
+
+        // Bucket b covers distances [b, b + 1) * length / n; store its first segment
+        int segment = 0;
+        for (int b = 0; b < n; ++b) {
+            float start = laneLength * b / n;
+            while (segment < n - 1 && arc[segment + 1] <= start) ++segment;
+            bucketSegment[b] = segment;
         }
-        glEnd();
-        glEnable(GL_TEXTURE_2D);
     }
 }
 
-// -------------------- Draw Curbs --------------------
-// Draws simple curbs/edges as thin line loops along inner and outer lane boundaries
-void Track::drawCurbs() {
-    glDisable(GL_TEXTURE_2D);
-    glLineWidth(2.0f);
-    glColor3f(0.9f, 0.9f, 0.9f);
+// -------------------- Segment Lookup --------------------
+// The bucket gives a segment at or before s; with near-uniform point spacing
+// the forward walk is at most a step or two
+int Track::segmentAt(int lane, float s) const {
+    const TrackGeometry& geo = *geometry;
+    int n = geo.pointCount;
+    const float* arc = &geo.arc[static_cast<size_t>(lane) * (n + 1)];
+    int bucket = static_cast<int>(s / geo.laneLengths[lane] * n);
+    bucket = std::max(0, std::min(bucket, n - 1));
 
-    // Inner boundary (lane1)
-    glBegin(GL_LINE_LOOP);
-    for (auto& p : lane1) glVertex2f(p.x, p.y);
-    glEnd();
+    int segment = geo.bucketSegment[static_cast<size_t>(lane) * n + bucket];
+    while (segment < n - 1 && arc[segment + 1] <= s) ++segment;
+    return segment;
+}
 
-    // Outer boundary (lane3)
-    glBegin(GL_LINE_LOOP);
-    for (auto& p : lane3) glVertex2f(p.x, p.y);
-    glEnd();
+// -------------------- Point Lookup --------------------
+Vector2 Track::pointAt(int lane, float s, int segment) const {
+    const TrackGeometry& geo = *geometry;
+    size_t i = static_cast<size_t>(lane) * geo.pointCount + segment;
+    return geo.points[i] + geo.tangent[i] * (s - arcAt(lane, segment));
+}
 
-    glEnable(GL_TEXTURE_2D);
+// -------------------- Curvature --------------------
+// Turn from this segment's heading to the next one over the mean length of the two
+float Track::curvatureAt(int lane, int segment) const {
+    int n = pointCount();
+    int next = (segment + 1) % n;
+    float turn = headingAt(lane, next) - headingAt(lane, segment);
+    if (turn > 180) turn -= 360;
+    if (turn < -180) turn += 360;
+    float length = 0.5f * (arcAt(lane, segment + 1) - arcAt(lane, segment) + arcAt(lane, next + 1) - arcAt(lane, next));
+    return length > 0.0f ? std::fabs(turn) * static_cast<float>(M_PI / 180.0) / length : 0.0f;
+}
+
+// -------------------- Track File Loading --------------------
+// FNV-1a hash of the source text; a cache is only used if it was compiled
+// from exactly the same text
+static std::uint64_t hashSource(const std::string& text) {
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
 }
 
-// -------------------- Draw Complete Track --------------------
-// Renders the full track in layers: grass, asphalt, curbs, and lane lines
-void Track::draw() {
-    drawGrass();     // Background
-    drawAsphalt();   // Road surface
-    drawCurbs();     // Track edges
+bool Track::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        printf("Error: cannot open track file %s\n", path.c_str());
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    // Fast path: geometry already compiled from this exact source
+    std::uint64_t sourceHash = hashSource(text);
+    std::string cachePath = path + ".cache";
+    float extentX, extentY;
+    if (std::shared_ptr<TrackGeometry> cached = readCache(cachePath, sourceHash, extentX, extentY)) {
+        adopt(std::move(cached), extentX, extentY);
+        return true;
+    }
+
+    // -------------------- Parse --------------------
+    // One keyword per line, '#' starts a comment:
+    //   points N       points per lane after resampling
+    //   lane OFFSET    adds a lane OFFSET units left of the center line
+    //   control X Y    adds a spline control point (in driving order)
+    int pointCount = 200;
+    std::vector<float> offsets;
+    std::vector<Vector2> controls;
 
-    // Draw lane lines for all three lanes
-    glLineWidth(3.0f);
-    glDisable(GL_TEXTURE_2D);
-    glColor3f(0.1f, 0.1f, 0.1f);
+    std::istringstream lines(text);
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(lines, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string key;
+        if (!(words >> key)) continue;
 
-    // Lambda helper to draw a lane as a line loop
-    auto drawLane = [](std::vector<Vector2>& lane) {
-        glBegin(GL_LINE_LOOP);
-        for (auto& p : lane) glVertex2f(p.x, p.y);
-        glEnd();
-        };
+        bool ok = true;
+        if (key == "points") ok = static_cast<bool>(words >> pointCount) && pointCount >= 3;
+        else if (key == "lane") {
+            float offset;
+            ok = static_cast<bool>(words >> offset) && std::isfinite(offset);
+            if (ok) offsets.push_back(offset);
+        }
+        else if (key == "control") {
+            float x, y;
+            ok = static_cast<bool>(words >> x >> y) && std::isfinite(x) && std::isfinite(y);
+            if (ok && !controls.empty() && controls.back().x == x && controls.back().y == y) {
+                printf("Error: %s:%d: control point repeats the previous one\n", path.c_str(), lineNumber);
+                return false;
+            }
+            if (ok) controls.push_back(Vector2(x, y));
+        }
+        else ok = false;
 
-    drawLane(lane1);
-    drawLane(lane2);
-    drawLane(lane3);
+        if (!ok) {
+            printf("Error: %s:%d: invalid line '%s'\n", path.c_str(), lineNumber, line.c_str());
+            return false;
+        }
+    }
+    if (controls.size() < 3) {
+        printf("Error: %s: a track needs at least 3 control points\n", path.c_str());
+        return false;
+    }
+    if (controls.front().x == controls.back().x && controls.front().y == controls.back().y) {
+        printf("Error: %s: the last control point repeats the first (the lap closes by itself)\n", path.c_str());
+        return false;
+    }
+    if (offsets.empty()) offsets.push_back(0.0f);
+
+    // -------------------- Generate & Compile --------------------
+    std::shared_ptr<TrackGeometry> geo = std::make_shared<TrackGeometry>();
+    geo->resize(static_cast<int>(offsets.size()), pointCount);
+    geo->laneOffsets = offsets;
+    buildFromSpline(*geo, controls);
+    buildLaneTables(*geo);
+    if (!validLengths(*geo)) {
+        printf("Error: %s: the track has a lane of zero or invalid length\n", path.c_str());
+        return false;
+    }
+    measureExtent(*geo, extentX, extentY);
+    adopt(std::move(geo), extentX, extentY);
 
-    glEnable(GL_TEXTURE_2D);
+    if (!writeCache(cachePath, sourceHash))
+        printf("Warning: could not write track cache %s\n", cachePath.c_str());
+    return true;
+}
+
+// Cars advance along a lane until they wrap its length, so every lane needs a
+// positive, finite one
+bool Track::validLengths(const TrackGeometry& geo) {
+    for (float length : geo.laneLengths)
+        if (!std::isfinite(length) || length <= 0.0f) return false;
+    return true;
+}
+
+// -------------------- Spline Sampling --------------------
+// Uniform Catmull-Rom point on the segment from p1 to p2 at t in [0, 1]
+static Vector2 catmullRom(const Vector2& p0, const Vector2& p1, const Vector2& p2, const Vector2& p3, float t) {
+    float t2 = t * t;
+    float t3 = t2 * t;
+    float a = -0.5f * t3 + t2 - 0.5f * t;
+    float b = 1.5f * t3 - 2.5f * t2 + 1.0f;
+    float c = -1.5f * t3 + 2.0f * t2 + 0.5f * t;
+    float d = 0.5f * t3 - 0.5f * t2;
+    return p0 * a + p1 * b + p2 * c + p3 * d;
+}
+
+// The spline is first sampled densely, then resampled at equal arc-length
+// steps so segmentAt's buckets hold about one segment each. Lane points are
+// the center line pushed sideways along its normal.
+void Track::buildFromSpline(TrackGeometry& geo, const std::vector<Vector2>& controls) {
+    int pointCount = geo.pointCount;
+    const int samplesPerSpan = 32;
+    int spans = static_cast<int>(controls.size());
+
+    // Dense polyline and its cumulative length
+    std::vector<Vector2> dense;
+    dense.reserve(spans * samplesPerSpan + 1);
+    for (int s = 0; s < spans; ++s) {
+        const Vector2& p0 = controls[(s - 1 + spans) % spans];
+        const Vector2& p1 = controls[s];
+        const Vector2& p2 = controls[(s + 1) % spans];
+        const Vector2& p3 = controls[(s + 2) % spans];
+        for (int k = 0; k < samplesPerSpan; ++k)
+            dense.push_back(catmullRom(p0, p1, p2, p3, static_cast<float>(k) / samplesPerSpan));
+    }
+    dense.push_back(dense.front());
+
+    std::vector<float> denseArc(dense.size(), 0.0f);
+    for (size_t i = 1; i < dense.size(); ++i)
+        denseArc[i] = denseArc[i - 1] + (dense[i] - dense[i - 1]).length();
+    float total = denseArc.back();
+
+    // Equal arc-length center line
+    std::vector<Vector2> center(pointCount);
+    size_t segment = 0;
+    for (int i = 0; i < pointCount; ++i) {
+        float s = total * i / pointCount;
+        while (segment + 2 < dense.size() && denseArc[segment + 1] <= s) ++segment;
+        float span = denseArc[segment + 1] - denseArc[segment];
+        float t = span > 0.0f ? (s - denseArc[segment]) / span : 0.0f;
+        center[i] = dense[segment] + (dense[segment + 1] - dense[segment]) * t;
+    }
+
+    // Offset lanes along the left normal of the center line
+    for (int i = 0; i < pointCount; ++i) {
+        Vector2 tangent = center[(i + 1) % pointCount] - center[(i - 1 + pointCount) % pointCount];
+        float length = tangent.length();
+        tangent = length > 0.0f ? tangent * (1.0f / length) : Vector2(1.0f, 0.0f);
+        Vector2 normal(-tangent.y, tangent.x);
+        for (int lane = 0; lane < geo.laneCount; ++lane)
+            geo.points[static_cast<size_t>(lane) * pointCount + i] = center[i] + normal * geo.laneOffsets[lane];
+    }
+}
+
+// -------------------- Extent --------------------
+void Track::measureExtent(const TrackGeometry& geo, float& extentX, float& extentY) {
+    extentX = extentY = 0.0f;
+    for (const auto& p : geo.points) {
+        extentX = std::max(extentX, std::fabs(p.x));
+        extentY = std::max(extentY, std::fabs(p.y));
+    }
+}
+
+// -------------------- Binary Cache --------------------
+// Layout (native byte order, checked through endianTag):
+//   TrackCacheHeader
+//   per lane: offset, length, points[n] (x, y), arc[n + 1], tangent[n] (x, y),
+//             heading[n], bucketSegment[n]
+// Every field is 4 bytes, so the whole file is an array of 32-bit words.
+static const char kTrackCacheMagic[8] = { 'D', 'R', 'S', 'T', 'R', 'A', 'C', 'K' };
+static const std::uint32_t kTrackCacheVersion = 1;   // Bump when the layout or generator changes
+static const std::uint32_t kTrackCacheEndianTag = 0x01020304;
+
+struct TrackCacheHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endianTag;
+    std::uint64_t sourceHash;
+    std::uint32_t laneCount;
+    std::uint32_t pointCount;
+    float radiusX;
+    float radiusY;
+};
+
+// Bytes of one lane record for n points
+static_assert(sizeof(int) == sizeof(std::int32_t), "bucketSegment is stored as 32-bit words");
+
+static size_t laneRecordSize(size_t n) {
+    return sizeof(float) * (2 + 2 * n + (n + 1) + 2 * n + n) + sizeof(std::int32_t) * n;
+}
+
+std::shared_ptr<TrackGeometry> Track::readCache(const std::string& cachePath, std::uint64_t sourceHash,
+    float& extentX, float& extentY) {
+    MappedFile file;
+    if (!file.open(cachePath) || file.size() < sizeof(TrackCacheHeader)) return nullptr;
+
+    TrackCacheHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, kTrackCacheMagic, sizeof(header.magic)) != 0 ||
+        header.version != kTrackCacheVersion || header.endianTag != kTrackCacheEndianTag ||
+        header.sourceHash != sourceHash || header.laneCount == 0 || header.pointCount < 3)
+        return nullptr;
+
+    size_t n = header.pointCount;
+    if (file.size() != sizeof(header) + header.laneCount * laneRecordSize(n)) return nullptr;
+
+    // Sequential reader over the mapped words; every lane record is copied
+    // straight into the lane's slice of the contiguous arrays
+    const unsigned char* cursor = file.data() + sizeof(header);
+    auto readWords = [&cursor](void* out, size_t count) {
+        memcpy(out, cursor, count * 4);
+        cursor += count * 4;
+    };
+    static_assert(sizeof(Vector2) == 2 * sizeof(float), "points are stored as packed (x, y) pairs");
+
+    std::shared_ptr<TrackGeometry> geo = std::make_shared<TrackGeometry>();
+    geo->resize(static_cast<int>(header.laneCount), static_cast<int>(n));
+    for (size_t lane = 0; lane < header.laneCount; ++lane) {
+        readWords(&geo->laneOffsets[lane], 1);
+        readWords(&geo->laneLengths[lane], 1);
+        readWords(&geo->points[lane * n], 2 * n);
+        readWords(&geo->arc[lane * (n + 1)], n + 1);
+        readWords(&geo->tangent[lane * n], 2 * n);
+        readWords(&geo->heading[lane * n], n);
+        readWords(&geo->bucketSegment[lane * n], n);
+    }
+    if (!validLengths(*geo)) return nullptr;
+
+    extentX = header.radiusX;
+    extentY = header.radiusY;
+    return geo;
+}
+
+// Written to a temporary file and renamed, so a reader never maps a half-written cache
+bool Track::writeCache(const std::string& cachePath, std::uint64_t sourceHash) const {
+    std::string tempPath = cachePath + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) return false;
+
+    TrackCacheHeader header = {};
+    memcpy(header.magic, kTrackCacheMagic, sizeof(header.magic));
+    header.version = kTrackCacheVersion;
+    header.endianTag = kTrackCacheEndianTag;
+    header.sourceHash = sourceHash;
+    header.laneCount = static_cast<std::uint32_t>(laneCount());
+    header.pointCount = static_cast<std::uint32_t>(pointCount());
+    header.radiusX = radiusX;
+    header.radiusY = radiusY;
+
+    const TrackGeometry& geo = *geometry;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    auto writeWords = [file, &ok](const void* words, size_t count) {
+        ok = ok && fwrite(words, 4, count, file) == count;
+    };
+    size_t n = geo.pointCount;
+    for (size_t lane = 0; lane < static_cast<size_t>(geo.laneCount) && ok; ++lane) {
+        writeWords(&geo.laneOffsets[lane], 1);
+        writeWords(&geo.laneLengths[lane], 1);
+        writeWords(&geo.points[lane * n], 2 * n);
+        writeWords(&geo.arc[lane * (n + 1)], n + 1);
+        writeWords(&geo.tangent[lane * n], 2 * n);
+        writeWords(&geo.heading[lane * n], n);
+        writeWords(&geo.bucketSegment[lane * n], n);
+    }
+    ok = fclose(file) == 0 && ok;
+
+    if (ok) {
+        std::remove(cachePath.c_str()); // rename() does not replace on Windows
+        ok = std::rename(tempPath.c_str(), cachePath.c_str()) == 0;
+    }
+    if (!ok) std::remove(tempPath.c_str());
+    return ok;
 }
@@ -1,60 +1,154 @@
 #pragma once
 #include "Vector2.h"
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 #include <cmath>
-#include <GL/glut.h>
+
+// -------------------- Lane View --------------------
+// Read-only view of one lane's points inside a track's shared buffer. Two
+// words, cheap to pass by value; valid while any Track sharing the geometry
+// is alive.
+struct LaneView {
+    const Vector2* points;   // First point of the lane
+    int count;               // Points in the lane
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    const Vector2& operator[](int i) const { return points[i]; }
+    const Vector2* begin() const { return points; }
+    const Vector2* end() const { return points + count; }
+};
+
+// -------------------- Track Geometry --------------------
+// Lane points and arc-length tables of every lane, each field in one
+// contiguous array, lane after lane. Built once and never modified after it
+// is handed to a Track, so any number of Tracks (e.g. concurrent races) can
+// share it without copying or locking.
+struct TrackGeometry {
+    int laneCount;                     // Number of lanes
+    int pointCount;                    // Points per lane (the same for every lane)
+
+    std::vector<Vector2> points;       // laneCount x pointCount lane points
+    std::vector<float> laneOffsets;    // Lateral offset of each lane (positive = left of travel)
+    std::vector<float> laneLengths;    // Length of one lap along each lane
+
+    // Segment i of a lane runs from point i to point (i + 1) % pointCount
+    std::vector<float> arc;            // laneCount x (pointCount + 1) cumulative arc length (last = length)
+    std::vector<Vector2> tangent;      // laneCount x pointCount unit tangent of each segment
+    std::vector<float> heading;        // laneCount x pointCount heading of each segment in degrees
+    std::vector<int> bucketSegment;    // laneCount x pointCount first segment of each uniform arc-length bucket
+
+    TrackGeometry() : laneCount(0), pointCount(0) {}
+
+    // Sizes every array for 'lanes' lanes of 'pointsPerLane' points
+    void resize(int lanes, int pointsPerLane);
+};
 
 // -------------------- Track Class --------------------
-// Represents a basic racing track with three parallel lanes (inner, center, outer)
-// Supports optional textures for visual enhancement: asphalt, grass, and curbs.
-// Provides methods to draw the track layers and manages track geometry.
+// Represents a closed racing track made of parallel lanes. The default
+// constructor builds the original ellipse with three lanes (center, outer,
+// inner); load() reads any closed spline track with any number of lanes.
+// Holds only the track geometry so it can be used by the GL-free simulation core.
+// Textures and drawing are handled by TrackRenderer (TrackRenderer.h).
+//
+// Every lane is also arc-length parameterised: the constructor precomputes
+// cumulative arc length, unit tangents and headings per segment, so cars can
+// move by a scalar distance along their lane and look up position and heading
+// in O(1) instead of normalising vectors and calling atan2 every tick.
+//
+// The geometry lives in one immutable TrackGeometry held by shared pointer:
+// copying a Track shares it instead of duplicating the lanes, and all
+// default-constructed Tracks share a single copy of the built-in ellipse.
 class Track {
 public:
-    // -------------------- Lane Geometry --------------------
-    // Each lane is a sequence of 2D points representing the path of that lane
-    std::vector<Vector2> lane1;  // Center lane
-    std::vector<Vector2> lane2;  // Outer lane (offset from center)
-    std::vector<Vector2> lane3;  // Inner lane (offset from center)
-
-    // -------------------- Optional Textures --------------------
-    // OpenGL texture IDs for rendering track surfaces
-    GLuint asphaltTextureID;  // Texture for road surface
-    GLuint grassTextureID;    // Texture for background/grass
-    GLuint curbTextureID;     // Texture for track edges/curbs
-
     // -------------------- Track Radii --------------------
-    // Horizontal (radiusX) and vertical (radiusY) radii of the track ellipse
+    // Horizontal (radiusX) and vertical (radiusY) extent of the track around the origin
     // Used to generate lane points and for simple boundary checks
     float radiusX;
     float radiusY;
 
     // -------------------- Constructor --------------------
-    // Initializes track geometry (elliptical lanes) and attempts to load textures
+    // Uses the built-in elliptical track (generated on first use, then shared)
     Track();
 
-    // -------------------- Public Draw Method --------------------
-    // Draws the full track in layers: grass, asphalt, curbs, and lane lines
-    void draw();
+    // -------------------- Loading --------------------
+    // Replaces the geometry with the track described by a text file (see
+    // README.md for the format). The generated lanes and tables are compiled
+    // into '<path>.cache' and memory-mapped on later loads while the source is
+    // unchanged. Returns false (and keeps the current track) on error.
+    bool load(const std::string& path);
+
+    // Generates a new copy of the built-in ellipse's geometry. Track() does
+    // this once and shares the result; this is for timing the generation.
+    static std::shared_ptr<const TrackGeometry> buildDefaultGeometry();
+
+    // -------------------- Lane Access --------------------
+    // Number of lanes, points per lane and the points of lane 0..laneCount()-1
+    int laneCount() const { return geometry->laneCount; }
+    int pointCount() const { return geometry->pointCount; }
+    LaneView lanePoints(int lane) const {
+        return { geometry->points.data() + static_cast<size_t>(lane) * geometry->pointCount, geometry->pointCount };
+    }
+
+    // Lateral offset of a lane from the center line (positive = left of travel)
+    float laneOffset(int lane) const { return geometry->laneOffsets[lane]; }
+
+    // The shared geometry (lanes and tables) of this track
+    const std::shared_ptr<const TrackGeometry>& sharedGeometry() const { return geometry; }
+
+    // -------------------- Arc-Length Queries --------------------
+    // Length of one lap along a lane
+    float laneLength(int lane) const { return geometry->laneLengths[lane]; }
+
+    // Arc length from the start of the lane to point 'index'
+    float arcAt(int lane, int index) const {
+        return geometry->arc[static_cast<size_t>(lane) * (geometry->pointCount + 1) + index];
+    }
+
+    // Segment containing distance s (0 <= s < laneLength), O(1) via the bucket table
+    int segmentAt(int lane, float s) const;
+
+    // Point at distance s along the lane, given the segment returned by segmentAt
+    Vector2 pointAt(int lane, float s, int segment) const;
+
+    // Heading of a segment in degrees
+    float headingAt(int lane, int segment) const {
+        return geometry->heading[static_cast<size_t>(lane) * geometry->pointCount + segment];
+    }
+
+    // Curvature (1 / turn radius) from a segment into the next, always >= 0
+    float curvatureAt(int lane, int segment) const;
 
 private:
-    // -------------------- Layered Drawing Methods --------------------
-    // Draw the grass background (plain or textured)
-    void drawGrass();
+    std::shared_ptr<const TrackGeometry> geometry; // Never null
 
-    // Draw the asphalt road surface (textured or plain fallback)
-    void drawAsphalt();
+    // The built-in ellipse, generated on first use
+    static std::shared_ptr<const TrackGeometry> defaultGeometry();
 
-    // Draw track curbs / lane boundaries as line loops
-    void drawCurbs();
+    // Builds the arc-length, tangent, heading and bucket tables for every lane
+    // of 'geo' from its points
+    static void buildLaneTables(TrackGeometry& geo);
 
-    // -------------------- Helper Method --------------------
-    // Loads a BMP texture file using the global loader (loadBMP_custom)
-    // Returns 0 if the file cannot be loaded
-    GLuint loadTexture(const char* filename);
-};
+    // Samples a closed Catmull-Rom spline through 'controls' into 'geo.pointCount'
+    // evenly spaced center-line points and offsets one lane per geo.laneOffsets entry
+    static void buildFromSpline(TrackGeometry& geo, const std::vector<Vector2>& controls);
+
+    // True if every lane length is positive and finite
+    static bool validLengths(const TrackGeometry& geo);
+
+    // Largest |x| and |y| over all lane points
+    static void measureExtent(const TrackGeometry& geo, float& extentX, float& extentY);
 
-// -------------------- Global Track Radii --------------------
-// File-scope global variables defined in Track.cpp
-// Can be used by other modules (e.g., Car.cpp) for boundary checks or camera limits
-extern float g_trackRadiusX;
-extern float g_trackRadiusY;
+    // Publishes 'geo' as this track's geometry and sets radiusX / radiusY
+    void adopt(std::shared_ptr<const TrackGeometry> geo, float extentX, float extentY);
+
+    // -------------------- Binary Cache --------------------
+    // Reads lanes and tables from a compiled cache; nullptr if missing, stale or corrupt
+    static std::shared_ptr<TrackGeometry> readCache(const std::string& cachePath, std::uint64_t sourceHash,
+        float& extentX, float& extentY);
+
+    // Writes lanes and tables to a compiled cache
+    bool writeCache(const std::string& cachePath, std::uint64_t sourceHash) const;
+};
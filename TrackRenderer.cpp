@@ -0,0 +1,487 @@
+#include "stdafx.h"
+#include "TrackRenderer.h"
+#include "Textures.h" // Provides g_textures for texture loading
+#include "Profiler.h"
+#include <GL/glut.h>
+#include <algorithm>
+#include <cmath>
+
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F // OpenGL 1.2; missing from the Windows GL 1.1 headers
+#endif
+
+// -------------------- Constructor --------------------
+// Only stores the track reference: the renderer may be a global constructed
+// before any GL context (or g_textures) exists, so textures are requested later
+TrackRenderer::TrackRenderer(const Track& track)
+    : asphaltTextureID(0), grassTextureID(0), curbTextureID(0), retained(true), track(track),
+    listBase(0), listCount(0), layerColumns(0), layerRows(0), layerOriginX(0.0f), layerOriginY(0.0f),
+    layerTileW(0.0f), layerTileH(0.0f), layerScaleX(0.0f), layerScaleY(0.0f)
+{
+}
+
+// -------------------- Textures --------------------
+// Optional textures from the executable folder; until they are uploaded
+// (or if they are missing) the plain fallback colours are drawn
+void TrackRenderer::requestTextures() {
+    g_textures.request("asphalt.bmp"); // Main road surface
+    g_textures.request("grass.bmp");   // Background
+    g_textures.request("curb.bmp");    // Track edges/curbs
+}
+
+// The display lists and layer tiles bake in the texture IDs, so they are
+// rebuilt when a texture arrives
+void TrackRenderer::refreshTextures() {
+    GLuint asphalt = g_textures.get("asphalt.bmp");
+    GLuint grass = g_textures.get("grass.bmp");
+    GLuint curb = g_textures.get("curb.bmp");
+    if (asphalt == asphaltTextureID && grass == grassTextureID && curb == curbTextureID) return;
+    asphaltTextureID = asphalt;
+    grassTextureID = grass;
+    curbTextureID = curb;
+    invalidate();
+}
+
+// -------------------- Edge Lanes --------------------
+// The road surface and curbs span the outermost lanes on either side
+void TrackRenderer::edgeLanes(int& rightLane, int& leftLane) const {
+    rightLane = leftLane = 0;
+    for (int lane = 1; lane < track.laneCount(); ++lane) {
+        if (track.laneOffset(lane) < track.laneOffset(rightLane)) rightLane = lane;
+        if (track.laneOffset(lane) > track.laneOffset(leftLane)) leftLane = lane;
+    }
+}
+
+// -------------------- Draw Grass --------------------
+// Square around the track, at least 80x80 units
+ViewRect TrackRenderer::grassExtent() const {
+    float e = std::max(40.0f, std::max(track.radiusX, track.radiusY) + 10.0f); // Half-size of the grass square
+    return { -e, -e, e, e };
+}
+
+// Renders the part of the track background inside 'area', either textured
+// or fallback plain green
+void TrackRenderer::drawGrass(const ViewRect& area) {
+    ViewRect grass = grassExtent();
+    float x0 = std::max(grass.minX, area.minX), x1 = std::min(grass.maxX, area.maxX);
+    float y0 = std::max(grass.minY, area.minY), y1 = std::min(grass.maxY, area.maxY);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    if (!grassTextureID) {
+        // Fallback plain grass
+        glDisable(GL_TEXTURE_2D);
+        glColor3f(0.85f, 0.95f, 0.85f);
+        glBegin(GL_QUADS);
+        glVertex2f(x0, y0);
+        glVertex2f(x1, y0);
+        glVertex2f(x1, y1);
+        glVertex2f(x0, y1);
+        glEnd();
+        glEnable(GL_TEXTURE_2D);
+        return;
+    }
+
+    // Optional: draw textured grass (currently using plain color)
+    glDisable(GL_TEXTURE_2D);
+    glColor3f(0.85f, 0.95f, 0.85f);
+    glBegin(GL_QUADS);
+    glVertex2f(x0, y0);
+    glVertex2f(x1, y0);
+    glVertex2f(x1, y1);
+    glVertex2f(x0, y1);
+    glEnd();
+    glEnable(GL_TEXTURE_2D);
+}
+
+// -------------------- Draw Asphalt --------------------
+// Draws the road surface between cross-sections first..last (inclusive, indices
+// wrap around the lap) using a texture if available, otherwise plain gray
+void TrackRenderer::drawAsphalt(int first, int last) {
+    int rightLane, leftLane;
+    edgeLanes(rightLane, leftLane);
+    LaneView outer = track.lanePoints(rightLane);
+    LaneView inner = track.lanePoints(leftLane);
+    int n = outer.size();
+
+    if (asphaltTextureID) {
+        // Bind texture and draw quad strip between inner and outer lane boundaries
+        glBindTexture(GL_TEXTURE_2D, asphaltTextureID);
+        glColor3ub(255, 255, 255);
+        glBegin(GL_QUAD_STRIP);
+
+        for (int i = first; i <= last; ++i) {
+            int idx = i % n;                  // Wrap around at the end
+            Vector2 pOuter = outer[idx];      // Outer lane point
+            Vector2 pInner = inner[idx];      // Inner lane point
+            float t = i / (float)n;           // Texture coordinate along track
+            glTexCoord2f(t * 4.0f, 0.0f); glVertex2f(pOuter.x, pOuter.y);
+            glTexCoord2f(t * 4.0f, 1.0f); glVertex2f(pInner.x, pInner.y);
+        }
+        glEnd();
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    else {
+        // Fallback plain road if texture missing
+        glDisable(GL_TEXTURE_2D);
+        glColor3f(0.2f, 0.2f, 0.2f);
+        glBegin(GL_QUAD_STRIP);
+
+        for (int i = first; i <= last; ++i) {
+            int idx = i % n;
+            Vector2 pOuter = outer[idx];
+            Vector2 pInner = inner[idx];
+            glVertex2f(pOuter.x, pOuter.y);
+            glVertex2f(pInner.x, pInner.y);
+        }
+        glEnd();
+        glEnable(GL_TEXTURE_2D);
+    }
+}
+
+// -------------------- Draw Curbs --------------------
+// Draws simple curbs/edges as thin lines along the outermost lanes
+void TrackRenderer::drawCurbs(int first, int last) {
+    glDisable(GL_TEXTURE_2D);
+    glLineWidth(2.0f);
+    glColor3f(0.9f, 0.9f, 0.9f);
+
+    int rightLane, leftLane;
+    edgeLanes(rightLane, leftLane);
+    drawLaneStrip(track.lanePoints(leftLane), first, last);   // Left boundary
+    drawLaneStrip(track.lanePoints(rightLane), first, last);  // Right boundary
+
+    glEnable(GL_TEXTURE_2D);
+}
+
+// -------------------- Draw Lane Lines --------------------
+// Draws the center line of every lane
+void TrackRenderer::drawLaneLines(int first, int last) {
+    glLineWidth(3.0f);
+    glDisable(GL_TEXTURE_2D);
+    glColor3f(0.1f, 0.1f, 0.1f);
+
+    for (int lane = 0; lane < track.laneCount(); ++lane)
+        drawLaneStrip(track.lanePoints(lane), first, last);
+
+    glEnable(GL_TEXTURE_2D);
+}
+
+// Line strip through lane points first..last (indices wrap around the lap)
+void TrackRenderer::drawLaneStrip(LaneView lane, int first, int last) {
+    int n = lane.size();
+    glBegin(GL_LINE_STRIP);
+    for (int i = first; i <= last; ++i) {
+        const Vector2& p = lane[i % n];
+        glVertex2f(p.x, p.y);
+    }
+    glEnd();
+}
+
+// -------------------- Retained Geometry --------------------
+// Splits the lap into chunks of consecutive cross-sections and compiles each
+// layer of each chunk into a display list. Chunks overlap by one cross-section
+// so the strips join seamlessly; their bounds are filed in a grid for view culling.
+void TrackRenderer::build() {
+    invalidate();
+
+    int n = track.pointCount();
+    chunks.clear();
+    for (int first = 0; first < n; first += kChunkSections) {
+        Chunk chunk;
+        chunk.first = first;
+        chunk.last = std::min(first + kChunkSections, n); // Section n wraps to section 0
+        chunk.minX = chunk.minY = 1e30f;
+        chunk.maxX = chunk.maxY = -1e30f;
+        for (int l = 0; l < track.laneCount(); ++l) {
+            LaneView lane = track.lanePoints(l);
+            for (int i = chunk.first; i <= chunk.last; ++i) {
+                const Vector2& p = lane[i % n];
+                chunk.minX = std::min(chunk.minX, p.x);
+                chunk.minY = std::min(chunk.minY, p.y);
+                chunk.maxX = std::max(chunk.maxX, p.x);
+                chunk.maxY = std::max(chunk.maxY, p.y);
+            }
+        }
+        chunks.push_back(chunk);
+    }
+
+    // Chunk grid: a chunk spans a few cells of about one chunk's size
+    chunkBounds.clear();
+    ViewRect all = { 1e30f, 1e30f, -1e30f, -1e30f };
+    float averageSize = 0.0f;
+    for (const auto& chunk : chunks) {
+        chunkBounds.push_back({ chunk.minX, chunk.minY, chunk.maxX, chunk.maxY });
+        all = { std::min(all.minX, chunk.minX), std::min(all.minY, chunk.minY),
+                std::max(all.maxX, chunk.maxX), std::max(all.maxY, chunk.maxY) };
+        averageSize += std::max(chunk.maxX - chunk.minX, chunk.maxY - chunk.minY);
+    }
+    averageSize /= std::max<size_t>(1, chunks.size());
+    chunkGrid.reset(all, std::max(averageSize, 1e-3f));
+    chunkGrid.buildBoxes(chunkBounds);
+
+    // One list per layer per chunk
+    int chunkCount = static_cast<int>(chunks.size());
+    listCount = 3 * chunkCount;
+    listBase = glGenLists(listCount);
+    if (!listBase) {
+        listCount = 0;
+        return;
+    }
+
+    asphaltLists.resize(chunkCount);
+    curbLists.resize(chunkCount);
+    laneLists.resize(chunkCount);
+    for (int k = 0; k < chunkCount; ++k) {
+        asphaltLists[k] = listBase + k;
+        curbLists[k] = listBase + chunkCount + k;
+        laneLists[k] = listBase + 2 * chunkCount + k;
+
+        glNewList(asphaltLists[k], GL_COMPILE);
+        drawAsphalt(chunks[k].first, chunks[k].last);
+        glEndList();
+
+        glNewList(curbLists[k], GL_COMPILE);
+        drawCurbs(chunks[k].first, chunks[k].last);
+        glEndList();
+
+        glNewList(laneLists[k], GL_COMPILE);
+        drawLaneLines(chunks[k].first, chunks[k].last);
+        glEndList();
+    }
+}
+
+// Frees the display lists and the cached layer; the next draw() rebuilds them
+void TrackRenderer::invalidate() {
+    releaseLayer();
+    if (listCount) glDeleteLists(listBase, listCount);
+    listBase = 0;
+    listCount = 0;
+    chunks.clear();
+    chunkBounds.clear();
+    asphaltLists.clear();
+    curbLists.clear();
+    laneLists.clear();
+}
+
+void TrackRenderer::drawLists() {
+    GLsizei chunkCount = static_cast<GLsizei>(chunks.size());
+    glCallLists(chunkCount, GL_UNSIGNED_INT, asphaltLists.data());
+    glCallLists(chunkCount, GL_UNSIGNED_INT, curbLists.data());
+    glCallLists(chunkCount, GL_UNSIGNED_INT, laneLists.data());
+}
+
+// Lines are a few pixels wide, so the view is padded a little before the query
+void TrackRenderer::drawLists(const ViewRect& view) {
+    ViewRect padded = view.expanded(0.5f);
+    chunkGrid.query(padded, visibleChunks);
+    visibleChunks.erase(std::remove_if(visibleChunks.begin(), visibleChunks.end(),
+        [this, &padded](int k) { return !chunkBounds[k].overlaps(padded); }), visibleChunks.end());
+    for (const std::vector<GLuint>* layer : { &asphaltLists, &curbLists, &laneLists }) {
+        visibleLists.clear();
+        for (int k : visibleChunks) visibleLists.push_back((*layer)[k]);
+        glCallLists(static_cast<GLsizei>(visibleLists.size()), GL_UNSIGNED_INT, visibleLists.data());
+    }
+}
+
+// -------------------- Cached Layer --------------------
+// Renders the road into the back buffer one square tile at a time, over the
+// grass color, and copies each tile into a texture. Tiles are aligned to whole
+// pixels of the target scale so they join without seams.
+void TrackRenderer::buildLayer(float scaleX, float scaleY) {
+    releaseLayer();
+    layerScaleX = scaleX;
+    layerScaleY = scaleY;
+    if (chunks.empty()) return;
+
+    // Road extent, padded for the line widths
+    float minX = chunks[0].minX, minY = chunks[0].minY;
+    float maxX = chunks[0].maxX, maxY = chunks[0].maxY;
+    for (const auto& chunk : chunks) {
+        minX = std::min(minX, chunk.minX);
+        minY = std::min(minY, chunk.minY);
+        maxX = std::max(maxX, chunk.maxX);
+        maxY = std::max(maxY, chunk.maxY);
+    }
+    minX -= 4.0f / scaleX;
+    maxX += 4.0f / scaleX;
+    minY -= 4.0f / scaleY;
+    maxY += 4.0f / scaleY;
+
+    // Largest power-of-two tile that fits in the window and a texture
+    GLint viewport[4], maxTexture;
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTexture);
+    int limit = std::min(std::min(viewport[2], viewport[3]), static_cast<int>(maxTexture));
+    int tileSize = 64;
+    while (tileSize * 2 <= limit && tileSize < kMaxTileSize) tileSize *= 2;
+    if (tileSize > limit) return;
+
+    float tileW = tileSize / scaleX;  // World size of one tile
+    float tileH = tileSize / scaleY;
+    int tilesX = static_cast<int>(std::ceil((maxX - minX) / tileW));
+    int tilesY = static_cast<int>(std::ceil((maxY - minY) / tileH));
+    if (tilesX * tilesY > kMaxLayerTiles) return;
+
+    // Snap the layer origin to the pixel grid of the target scale
+    float originX = std::floor(minX * scaleX) / scaleX;
+    float originY = std::floor(minY * scaleY) / scaleY;
+    layerTiles.assign(tilesX * tilesY, 0);
+    layerColumns = tilesX;
+    layerRows = tilesY;
+    layerOriginX = originX;
+    layerOriginY = originY;
+    layerTileW = tileW;
+    layerTileH = tileH;
+
+    GLfloat clearColor[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glViewport(0, 0, tileSize, tileSize);
+    glClearColor(0.85f, 0.95f, 0.85f, 1.0f); // Grass color
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    std::vector<unsigned char> pixels(tileSize * tileSize * 3);
+
+    // The grass colour as the framebuffer stores it, to recognise grass-only tiles
+    unsigned char grass[3];
+    glClear(GL_COLOR_BUFFER_BIT);
+    glReadPixels(0, 0, 1, 1, GL_RGB, GL_UNSIGNED_BYTE, grass);
+
+    for (int ty = 0; ty < tilesY; ++ty) {
+        for (int tx = 0; tx < tilesX; ++tx) {
+            float x0 = originX + tx * tileW;
+            float y0 = originY + ty * tileH;
+
+            glMatrixMode(GL_PROJECTION);
+            glLoadIdentity();
+            glOrtho(x0, x0 + tileW, y0, y0 + tileH, -1.0, 1.0);
+            glMatrixMode(GL_MODELVIEW);
+            glLoadIdentity();
+            glClear(GL_COLOR_BUFFER_BIT);
+            drawLists();
+
+            // Tiles with nothing but grass are left out; the grass list shows through
+            glReadPixels(0, 0, tileSize, tileSize, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+            bool empty = true;
+            for (size_t i = 0; i < pixels.size() && empty; i += 3)
+                empty = pixels[i] == grass[0] && pixels[i + 1] == grass[1] && pixels[i + 2] == grass[2];
+            if (empty) continue;
+
+            GLuint& texture = layerTiles[ty * tilesX + tx];
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 0, 0, tileSize, tileSize, 0);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Restore the frame state and wipe the scratch drawing
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void TrackRenderer::releaseLayer() {
+    for (GLuint texture : layerTiles)
+        if (texture) glDeleteTextures(1, &texture);
+    layerTiles.clear();
+    layerColumns = layerRows = 0;
+    layerScaleX = layerScaleY = 0.0f;
+}
+
+// -------------------- Draw Complete Track --------------------
+// Renders the track in layers: grass, asphalt, curbs, and lane lines.
+// The retained path draws the visible grass and cached layer tiles, or the
+// visible chunks' lists when no layer could be built for this zoom.
+void TrackRenderer::draw() {
+    PROFILE_SCOPE("Track::draw");
+    if (!retained) {
+        int n = track.pointCount();
+        drawGrass(grassExtent()); // Background
+        drawAsphalt(0, n);       // Road surface
+        drawCurbs(0, n);         // Track edges
+        drawLaneLines(0, n);     // Lane lines
+        return;
+    }
+
+    if (!listCount) build();
+    if (!listCount) return;
+
+    // Current pixels per world unit (the views only translate and scale)
+    GLfloat projection[16], modelview[16];
+    GLint viewport[4];
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    float scaleX = std::fabs(projection[0] * modelview[0]) * viewport[2] * 0.5f;
+    float scaleY = std::fabs(projection[5] * modelview[5]) * viewport[3] * 0.5f;
+    if (std::fabs(scaleX - layerScaleX) > 1e-3f * scaleX || std::fabs(scaleY - layerScaleY) > 1e-3f * scaleY)
+        buildLayer(scaleX, scaleY);
+
+    ViewRect view = visibleWorldRect();
+    drawGrass(view);
+    if (!drawLayer(view)) drawLists(view);
+}
+
+// Tiles covering the view are found by index: the layer is a regular grid
+bool TrackRenderer::drawLayer(const ViewRect& view) {
+    if (layerTiles.empty()) return false;
+
+    int tx0 = std::max(0, static_cast<int>(std::floor((view.minX - layerOriginX) / layerTileW)));
+    int ty0 = std::max(0, static_cast<int>(std::floor((view.minY - layerOriginY) / layerTileH)));
+    int tx1 = std::min(layerColumns - 1, static_cast<int>(std::floor((view.maxX - layerOriginX) / layerTileW)));
+    int ty1 = std::min(layerRows - 1, static_cast<int>(std::floor((view.maxY - layerOriginY) / layerTileH)));
+
+    glEnable(GL_TEXTURE_2D);
+    glColor3ub(255, 255, 255);
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            GLuint texture = layerTiles[ty * layerColumns + tx];
+            if (!texture) continue; // Grass only
+            float x0 = layerOriginX + tx * layerTileW, y0 = layerOriginY + ty * layerTileH;
+            float x1 = x0 + layerTileW, y1 = y0 + layerTileH;
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glBegin(GL_QUADS);
+            glTexCoord2f(0.0f, 0.0f); glVertex2f(x0, y0);
+            glTexCoord2f(1.0f, 0.0f); glVertex2f(x1, y0);
+            glTexCoord2f(1.0f, 1.0f); glVertex2f(x1, y1);
+            glTexCoord2f(0.0f, 1.0f); glVertex2f(x0, y1);
+            glEnd();
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+// -------------------- View Rectangle --------------------
+// Maps the viewport corners back through projection * modelview; both are
+// scale-and-translate matrices here, so each axis inverts on its own
+ViewRect visibleWorldRect(float* pixelsPerUnit) {
+    GLfloat projection[16], modelview[16];
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+    float scaleX = projection[0] * modelview[0];
+    float scaleY = projection[5] * modelview[5];
+    float offsetX = projection[0] * modelview[12] + projection[12];
+    float offsetY = projection[5] * modelview[13] + projection[13];
+    if (scaleX == 0.0f || scaleY == 0.0f) return { -1e30f, -1e30f, 1e30f, 1e30f };
+
+    float ax = (-1.0f - offsetX) / scaleX, bx = (1.0f - offsetX) / scaleX;
+    float ay = (-1.0f - offsetY) / scaleY, by = (1.0f - offsetY) / scaleY;
+    if (pixelsPerUnit) {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        *pixelsPerUnit = std::fabs(scaleX) * viewport[2] * 0.5f;
+    }
+    return { std::min(ax, bx), std::min(ay, by), std::max(ax, bx), std::max(ay, by) };
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include "Track.h"
+#include "SpatialGrid.h"
+#include <GL/glut.h>
+#include <vector>
+
+// -------------------- TrackRenderer Class --------------------
+// Draws a Track with OpenGL. Owns the optional track textures (asphalt, grass,
+// curbs) so that the Track class itself carries no GL state.
+//
+// The track never changes while racing, so it is not re-sent vertex by vertex
+// every frame:
+//   - its geometry is compiled once into display lists (split into chunks of
+//     consecutive cross-sections, each with its own bounding box), and
+//   - those lists are rendered once into a cached layer of textures covering
+//     the whole track at the current screen scale, which is then drawn as a
+//     few textured quads. The layer is rebuilt only when the zoom changes;
+//     panning just moves the quads.
+// If the layer would need too many textures (very high zoom), the lists are
+// drawn directly instead.
+//
+// Only what is on screen is submitted: the grass quad is clipped to the view,
+// layer tiles are picked from the view by index, and chunk lists are looked
+// up in a SpatialGrid over the chunk bounds.
+class TrackRenderer {
+public:
+    // -------------------- Optional Textures --------------------
+    // OpenGL texture IDs for rendering track surfaces
+    GLuint asphaltTextureID;  // Texture for road surface
+    GLuint grassTextureID;    // Texture for background/grass
+    GLuint curbTextureID;     // Texture for track edges/curbs
+
+    bool retained;            // Use the cached layer / display lists (false = immediate mode every frame)
+
+    // -------------------- Constructor --------------------
+    // Binds the renderer to a track; no textures and no GL calls yet
+    explicit TrackRenderer(const Track& track);
+
+    TrackRenderer(const TrackRenderer&) = delete;
+    TrackRenderer& operator=(const TrackRenderer&) = delete;
+
+    // -------------------- Public Draw Methods --------------------
+    // Draws the full track in layers: grass, asphalt, curbs, and lane lines.
+    // Must be the first thing drawn after clearing the frame: rebuilding the
+    // cached layer uses the back buffer as scratch space and clears it again.
+    void draw();
+
+    // Drops the compiled geometry (e.g. after the track was reloaded); it is
+    // rebuilt by the next draw()
+    void invalidate();
+
+    // -------------------- Textures --------------------
+    // Queues the track textures on g_textures' loader threads (no GL needed)
+    void requestTextures();
+
+    // Picks up textures uploaded since the last call (0 = still loading or
+    // missing); call on the GL thread after TextureManager::pumpUploads()
+    void refreshTextures();
+
+private:
+    const Track& track; // Geometry being rendered
+
+    // -------------------- Retained Geometry --------------------
+    // Cross-sections first..last of the lap (last may equal the point count,
+    // which wraps to section 0) and their bounds
+    struct Chunk {
+        int first, last;
+        float minX, minY, maxX, maxY;
+    };
+    static const int kChunkSections = 32;  // Cross-sections per chunk
+
+    std::vector<Chunk> chunks;
+    std::vector<ViewRect> chunkBounds;    // Bounds of every chunk, filed in chunkGrid
+    SpatialGrid chunkGrid;                // Chunks by area, for culling the direct path
+    std::vector<int> visibleChunks;       // Scratch for queries
+    std::vector<GLuint> visibleLists;     // Scratch for glCallLists
+    GLuint listBase;                      // First display list (0 = not built)
+    int listCount;                        // Display lists allocated from listBase
+    std::vector<GLuint> asphaltLists;     // Road surface, one per chunk
+    std::vector<GLuint> curbLists;        // Edge lines, one per chunk
+    std::vector<GLuint> laneLists;        // Lane lines, one per chunk
+
+    // -------------------- Cached Layer --------------------
+    // A grid of layerColumns x layerRows tiles of layerTileW x layerTileH world
+    // units from (layerOriginX, layerOriginY); tile (x, y) is
+    // layerTiles[y * layerColumns + x], texture 0 where it holds only grass
+    static const int kMaxTileSize = 256;   // Texture size of one tile (smaller tiles skip more grass)
+    static const int kMaxLayerTiles = 256; // Above this the lists are drawn directly
+
+    std::vector<GLuint> layerTiles;
+    int layerColumns, layerRows;
+    float layerOriginX, layerOriginY;
+    float layerTileW, layerTileH;
+    float layerScaleX, layerScaleY;       // Pixels per world unit the layer was built for (0 = none)
+
+    // Compiles the display lists for the current track geometry
+    void build();
+
+    // Replays the chunk lists (asphalt, curbs, lane lines) of every chunk
+    void drawLists();
+
+    // Replays the lists of the chunks overlapping 'view'
+    void drawLists(const ViewRect& view);
+
+    // Draws the layer tiles overlapping 'view'; false if there is no layer
+    bool drawLayer(const ViewRect& view);
+
+    // Renders the lists into layer textures at the given pixels per world unit
+    void buildLayer(float scaleX, float scaleY);
+
+    // Deletes the layer textures
+    void releaseLayer();
+
+    // -------------------- Layered Drawing Methods --------------------
+    // Draw the grass background (plain or textured), clipped to 'area'
+    void drawGrass(const ViewRect& area);
+
+    // The full grass square around the track
+    ViewRect grassExtent() const;
+
+    // Draw the asphalt road surface (textured or plain fallback) between
+    // cross-sections first..last
+    void drawAsphalt(int first, int last);
+
+    // Draw track curbs (outermost lane boundaries) between cross-sections first..last
+    void drawCurbs(int first, int last);
+
+    // Draw every lane's center line between cross-sections first..last
+    void drawLaneLines(int first, int last);
+
+    // Line strip through lane points first..last, indices wrapping around the lap
+    static void drawLaneStrip(LaneView lane, int first, int last);
+
+    // -------------------- Helper Methods --------------------
+    // Lanes with the smallest and largest lateral offset (the road edges)
+    void edgeLanes(int& rightLane, int& leftLane) const;
+};
+
+// -------------------- View Rectangle --------------------
+// World rectangle visible through the current projection and modelview
+// (which only translate and scale); optionally returns the horizontal pixels
+// per world unit
+ViewRect visibleWorldRect(float* pixelsPerUnit = nullptr);
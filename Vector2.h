@@ -0,0 +1,29 @@
+#pragma once
+#include <cmath>
+
+// -------------------- Vector2 Struct --------------------
+// 2D vector of floats for positions, velocities and offsets. Kept to two
+// packed floats (Track stores its points as plain (x, y) pairs).
+struct Vector2 {
+    float x;
+    float y;
+
+    Vector2() : x(0.0f), y(0.0f) {}
+    Vector2(float x, float y) : x(x), y(y) {}
+
+    // -------------------- Arithmetic --------------------
+    Vector2 operator+(const Vector2& other) const { return Vector2(x + other.x, y + other.y); }
+    Vector2 operator-(const Vector2& other) const { return Vector2(x - other.x, y - other.y); }
+    Vector2 operator*(float scale) const { return Vector2(x * scale, y * scale); }
+    Vector2& operator+=(const Vector2& other) { x += other.x; y += other.y; return *this; }
+    Vector2& operator-=(const Vector2& other) { x -= other.x; y -= other.y; return *this; }
+
+    // -------------------- Geometry --------------------
+    float length() const { return std::sqrt(x * x + y * y); }
+
+    // Unit vector in the same direction; the zero vector stays zero
+    Vector2 normalized() const {
+        float l = length();
+        return l > 0.0f ? Vector2(x / l, y / l) : Vector2(0.0f, 0.0f);
+    }
+};
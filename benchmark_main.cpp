@@ -0,0 +1,509 @@
+// benchmark_main.cpp : micro and scaling benchmarks for the GL-free simulation core.
+// Times the car update (lane index, full scan, CarFleet and CarFleet with all
+// three car models in one race) at 3 to 100k cars, car collision detection,
+// track generation and cache loading, BMP decoding and the standings update,
+// prints a table and optionally writes the results as JSON. A JSON file from
+// an earlier run can be given as a baseline; slower results are flagged and
+// make the run exit with status 1.
+//
+// Usage: benchmark [--filter TEXT] [--min-time SECONDS] [--json FILE]
+//                  [--baseline FILE] [--threshold PERCENT] [--scratch DIR]
+
+#include "Simulation.h"
+#include "CarFleet.h"
+#include "Standings.h"
+#include "Image.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// -------------------- Run Options --------------------
+struct BenchmarkOptions {
+    const char* filter = nullptr;   // Only run benchmarks whose name contains this
+    double minTime = 0.5;           // Seconds of measurement per benchmark
+    const char* json = nullptr;     // Results file
+    const char* baseline = nullptr; // Earlier results file to compare against
+    double threshold = 10.0;        // Percent slower than the baseline that counts as a regression
+    std::string scratch;            // Directory for the generated track and images
+};
+
+// -------------------- Usage --------------------
+static void printUsage(const char* exe) {
+    printf("Usage: %s [--filter TEXT] [--min-time SECONDS] [--json FILE]\n"
+           "       [--baseline FILE] [--threshold PERCENT] [--scratch DIR]\n", exe);
+}
+
+// -------------------- Argument Parsing --------------------
+static bool parseArgs(int argc, char** argv, BenchmarkOptions& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(arg, "--filter") && hasValue) opt.filter = argv[++i];
+        else if (!strcmp(arg, "--min-time") && hasValue) opt.minTime = atof(argv[++i]);
+        else if (!strcmp(arg, "--json") && hasValue) opt.json = argv[++i];
+        else if (!strcmp(arg, "--baseline") && hasValue) opt.baseline = argv[++i];
+        else if (!strcmp(arg, "--threshold") && hasValue) opt.threshold = atof(argv[++i]);
+        else if (!strcmp(arg, "--scratch") && hasValue) opt.scratch = argv[++i];
+        else return false;
+    }
+    if (opt.scratch.empty()) {
+        std::error_code error;
+        opt.scratch = std::filesystem::temp_directory_path(error).string();
+        if (error) opt.scratch = ".";
+    }
+    return opt.minTime > 0.0 && opt.threshold >= 0.0;
+}
+
+// -------------------- Benchmark Runner --------------------
+// One result per benchmark; times are per operation (one car update, one
+// standings update, one track load...), the median of kSamples samples
+struct BenchmarkResult {
+    std::string name;
+    long long opsPerIteration;  // Operations done by one call of the body
+    long long iterations;       // Body calls per sample
+    double nsPerOp;             // Median over the samples
+    double minNsPerOp;
+    double maxNsPerOp;
+};
+
+class BenchmarkRunner {
+public:
+    static const int kSamples = 5;
+
+    std::vector<BenchmarkResult> results;
+
+    explicit BenchmarkRunner(const BenchmarkOptions& opt) : opt(opt) {}
+
+    // True if 'name' passes --filter (lets callers skip expensive setup)
+    bool selected(const std::string& name) const {
+        return !opt.filter || name.find(opt.filter) != std::string::npos;
+    }
+
+    // Times body(iterations). The iteration count grows until a sample
+    // takes minTime / kSamples, then kSamples samples are taken.
+    void run(const std::string& name, long long opsPerIteration, const std::function<void(long long)>& body) {
+        if (!selected(name)) return;
+        double sampleSeconds = opt.minTime / kSamples;
+
+        body(1); // Warm-up: first-touch page faults, lazy allocations
+        long long iterations = 1;
+        double seconds = time(body, iterations);
+        while (seconds < sampleSeconds && iterations < (1LL << 40)) {
+            // Jump close to the target, but at most 10x per round
+            double scale = seconds > 0.0 ? std::min(10.0, 1.2 * sampleSeconds / seconds) : 10.0;
+            iterations = std::max(iterations + 1, static_cast<long long>(iterations * scale));
+            seconds = time(body, iterations);
+        }
+
+        std::vector<double> perOp(kSamples);
+        perOp[0] = seconds * 1e9 / (static_cast<double>(iterations) * opsPerIteration);
+        for (int s = 1; s < kSamples; ++s)
+            perOp[s] = time(body, iterations) * 1e9 / (static_cast<double>(iterations) * opsPerIteration);
+        std::sort(perOp.begin(), perOp.end());
+
+        BenchmarkResult result = { name, opsPerIteration, iterations, perOp[kSamples / 2], perOp.front(), perOp.back() };
+        printf("%-36s %14.2f %14.2f %14.2f %12lld\n", name.c_str(), result.nsPerOp, result.minNsPerOp,
+            result.maxNsPerOp, iterations);
+        fflush(stdout);
+        results.push_back(result);
+    }
+
+private:
+    const BenchmarkOptions& opt;
+
+    static double time(const std::function<void(long long)>& body, long long iterations) {
+        auto start = std::chrono::steady_clock::now();
+        body(iterations);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// -------------------- Car Update --------------------
+// A full grid of N cars stepped with the simulation's dt; one op = one car update.
+// The all-cars scan is O(N^2) per tick and stops at 1000 cars. fleet_mixed
+// deals the kinematic, grip and aggressive models out in turn.
+static const int kFieldSizes[] = { 3, 100, 1000, 10000, 100000 };
+static const float kStepSeconds = 0.016f;
+
+static void benchCarUpdate(BenchmarkRunner& runner) {
+    for (int cars : kFieldSizes) {
+        std::string suffix = "/" + std::to_string(cars);
+        for (int mode = 0; mode < 4; ++mode) {
+            static const char* modeNames[] = { "car_update/lane_index", "car_update/scan", "car_update/fleet",
+                "car_update/fleet_mixed" };
+            const char* modeName = modeNames[mode];
+            std::string name = modeName + suffix;
+            if (!runner.selected(name) || (mode == 1 && cars > 1000)) continue;
+
+            Simulation sim;
+            srand(1);
+            sim.setupGrid(cars);
+            sim.useLaneIndex = mode != 1;
+            if (mode == 3) {
+                for (int i = 0; i < cars; ++i) sim.cars[i].model = static_cast<CarModel>(i % kCarModelCount);
+            }
+            if (mode >= 2) {
+                CarFleet fleet(&sim.track);
+                fleet.assign(sim.cars);
+                runner.run(name, cars, [&fleet](long long n) {
+                    for (long long i = 0; i < n; ++i) fleet.step(kStepSeconds, nullptr);
+                });
+            }
+            else {
+                runner.run(name, cars, [&sim](long long n) {
+                    for (long long i = 0; i < n; ++i) sim.step(kStepSeconds);
+                });
+            }
+        }
+    }
+}
+
+// -------------------- Standings --------------------
+// Race progress of two consecutive ticks of a race 200 ticks in (advanced
+// with CarFleet, the fastest stepper), applied alternately: the incremental update undoes and redoes that tick's
+// overtakes, as it does once per step. full_sort is the per-frame sort the
+// sidebar used to do.
+static void benchStandings(BenchmarkRunner& runner) {
+    for (int cars : kFieldSizes) {
+        std::string suffix = "/" + std::to_string(cars);
+        if (!runner.selected("standings/incremental" + suffix) && !runner.selected("standings/full_sort" + suffix)) continue;
+
+        Simulation sim;
+        srand(1);
+        sim.setupGrid(cars);
+        CarFleet fleet(&sim.track);
+        fleet.assign(sim.cars);
+        for (int t = 0; t < 200; ++t) fleet.step(kStepSeconds, nullptr);
+        std::vector<float> before(cars), after(cars);
+        fleet.storeTo(sim.cars);
+        for (int i = 0; i < cars; ++i) before[i] = sim.cars[i].raceProgress();
+        fleet.step(kStepSeconds, nullptr);
+        fleet.storeTo(sim.cars);
+        for (int i = 0; i < cars; ++i) after[i] = sim.cars[i].raceProgress();
+
+        Standings standings;
+        standings.update(cars, before.data());
+        runner.run("standings/incremental" + suffix, 1, [&](long long n) {
+            for (long long i = 0; i < n; ++i) standings.update(cars, (i & 1) ? before.data() : after.data());
+        });
+
+        std::vector<int> order(cars);
+        runner.run("standings/full_sort" + suffix, 1, [&](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                const float* progress = (i & 1) ? before.data() : after.data();
+                std::iota(order.begin(), order.end(), 0);
+                std::sort(order.begin(), order.end(), [progress](int a, int b) {
+                    return progress[a] != progress[b] ? progress[a] > progress[b] : a < b;
+                });
+            }
+        });
+    }
+}
+
+// -------------------- Collisions --------------------
+// Overlap detection on a race 200 ticks in (CarFleet with collisions on); one
+// op = one car. sweep is CarCollisions::detect (broadphase and narrowphase),
+// all_pairs the bounding-box test of every pair it replaces. Both stop at
+// 10000 cars: the default track holds a few hundred cars without overlaps.
+static volatile long long overlapSink; // Keeps the all_pairs loop from being optimised away
+
+static void benchCollisions(BenchmarkRunner& runner) {
+    for (int cars : kFieldSizes) {
+        std::string suffix = "/" + std::to_string(cars);
+        if (cars > 10000 || (!runner.selected("collisions/sweep" + suffix) && !runner.selected("collisions/all_pairs" + suffix)))
+            continue;
+
+        Simulation sim;
+        srand(1);
+        sim.setupGrid(cars);
+        CarFleet fleet(&sim.track);
+        fleet.assign(sim.cars);
+        fleet.collisions = true;
+        for (int t = 0; t < 200; ++t) fleet.step(kStepSeconds, nullptr);
+        const CarFleet::HotState& hot = fleet.hot;
+
+        CarCollisions collider;
+        runner.run("collisions/sweep" + suffix, cars, [&](long long n) {
+            for (long long i = 0; i < n; ++i)
+                collider.detect(cars, hot.posX.data(), hot.posY.data(), hot.rotation.data(), hot.size.data());
+        });
+
+        runner.run("collisions/all_pairs" + suffix, cars, [&](long long n) {
+            long long overlaps = 0;
+            for (long long i = 0; i < n; ++i) {
+                for (int a = 0; a < cars; ++a) {
+                    float reach = hot.size[a] * 1.4143f;
+                    for (int b = a + 1; b < cars; ++b) {
+                        float limit = reach + hot.size[b] * 1.4143f;
+                        if (std::fabs(hot.posX[a] - hot.posX[b]) <= limit && std::fabs(hot.posY[a] - hot.posY[b]) <= limit)
+                            ++overlaps;
+                    }
+                }
+            }
+            overlapSink = overlaps;
+        });
+    }
+}
+
+// -------------------- Track Generation --------------------
+// Generating the built-in ellipse (Track() shares one copy, so it is built
+// directly), and a generated 4000-point, 5-lane track file loaded with and
+// without its compiled cache
+static void benchTrack(BenchmarkRunner& runner, const std::string& scratch) {
+    runner.run("track/default", 1, [](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            std::shared_ptr<const TrackGeometry> geo = Track::buildDefaultGeometry();
+            if (geo->laneLengths[0] <= 0.0f) printf("Error: empty track\n");
+        }
+    });
+
+    if (!runner.selected("track/load")) return;
+    std::string path = scratch + "/benchmark.track";
+    std::string cachePath = path + ".cache";
+    {
+        std::ofstream file(path);
+        file << "points 4000\n";
+        for (float offset : { -3.0f, -1.5f, 0.0f, 1.5f, 3.0f }) file << "lane " << offset << "\n";
+        for (int i = 0; i < 24; ++i) {
+            float angle = i * 6.2831853f / 24;
+            float radius = 40.0f + ((i % 3) - 1) * 6.0f; // Wavy outline
+            file << "control " << radius * 1.5f * std::cos(angle) << " " << radius * std::sin(angle) << "\n";
+        }
+        if (!file) {
+            printf("Error: cannot write %s, skipping track/load\n", path.c_str());
+            return;
+        }
+    }
+
+    runner.run("track/load_uncached", 1, [&](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            std::remove(cachePath.c_str());
+            Track track;
+            track.load(path);
+        }
+    });
+    runner.run("track/load_cached", 1, [&](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            Track track;
+            track.load(path);
+        }
+    });
+    std::remove(cachePath.c_str());
+    std::remove(path.c_str());
+}
+
+// -------------------- Image Decoding --------------------
+// Large 24-bit BMPs as loaded by loadBMP_custom (the GL upload is not part of
+// the GL-free build). decode_bmp maps the file, faults its pixels in and
+// copies the rows out (decode_bmp_cold with the file evicted from the page
+// cache first); swap_red_blue is the copy-and-swizzle fallback for drivers
+// without BGR upload.
+static bool writeTestBMP(const std::string& path, int size) {
+    int rowStride = (size * 3 + 3) & ~3;
+    std::uint32_t pixelBytes = static_cast<std::uint32_t>(rowStride) * size;
+    unsigned char header[54] = { 'B', 'M' };
+    auto put32 = [&header](int offset, std::uint32_t value) {
+        for (int b = 0; b < 4; ++b) header[offset + b] = static_cast<unsigned char>(value >> (8 * b));
+    };
+    put32(2, 54 + pixelBytes);  // File size
+    put32(10, 54);              // Pixel data offset
+    put32(14, 40);              // BITMAPINFOHEADER size
+    put32(18, size);            // Width
+    put32(22, size);            // Height (positive = bottom-up)
+    header[26] = 1;             // Planes
+    header[28] = 24;            // Bits per pixel
+    put32(34, pixelBytes);
+
+    std::vector<unsigned char> row(rowStride);
+    for (int x = 0; x < rowStride; ++x) row[x] = static_cast<unsigned char>(x * 7);
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    for (int y = 0; y < size && ok; ++y) ok = fwrite(row.data(), 1, row.size(), file) == row.size();
+    if (fclose(file) != 0) ok = false;
+    return ok;
+}
+
+// Asks the OS to drop the file's cached pages, so the next load reads it from
+// disk. Returns false where that is not possible (Windows); on tmpfs the
+// call succeeds but the pages stay.
+static bool evictFromPageCache(const std::string& path) {
+#ifdef _WIN32
+    (void)path;
+    return false;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return ok;
+#endif
+}
+
+// The CPU side of getting a BMP to the GPU: loadBMP maps the file and checks
+// the headers, the page walk faults the mapping in as AssetLoader's workers
+// do, and the rows are copied out at their stride as the GL upload reads them
+static void decodeForUpload(const std::string& path, std::vector<unsigned char>& packed) {
+    Image image;
+    if (!image.loadBMP(path)) {
+        printf("Error: cannot load %s\n", path.c_str());
+        return;
+    }
+    volatile unsigned char sink = 0;
+    for (size_t i = 0; i < image.byteSize(); i += 4096) sink = sink + image.pixels[i];
+    size_t rowBytes = static_cast<size_t>(image.width) * image.channels;
+    packed.resize(rowBytes * image.height);
+    for (int row = 0; row < image.height; ++row)
+        memcpy(&packed[row * rowBytes], image.pixels + static_cast<size_t>(row) * image.rowStride, rowBytes);
+}
+
+static void benchImage(BenchmarkRunner& runner, const std::string& scratch) {
+    for (int size : { 1024, 4096 }) {
+        std::string suffix = "/" + std::to_string(size);
+        if (!runner.selected("image/decode_bmp" + suffix) && !runner.selected("image/swap_red_blue" + suffix)) continue;
+
+        std::string path = scratch + "/benchmark" + suffix.substr(1) + ".bmp";
+        if (!writeTestBMP(path, size)) {
+            printf("Error: cannot write %s, skipping image benchmarks\n", path.c_str());
+            continue;
+        }
+        // A fresh mapping per load: warm page cache, but every page is faulted in again
+        std::vector<unsigned char> packed;
+        runner.run("image/decode_bmp" + suffix, 1, [&](long long n) {
+            for (long long i = 0; i < n; ++i) decodeForUpload(path, packed);
+        });
+        // The same with the file's pages dropped first, so each load also reads the disk
+        if (evictFromPageCache(path)) {
+            runner.run("image/decode_bmp_cold" + suffix, 1, [&](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    evictFromPageCache(path);
+                    decodeForUpload(path, packed);
+                }
+            });
+        }
+        runner.run("image/swap_red_blue" + suffix, 1, [&path](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                Image image;
+                if (image.loadBMP(path)) image.swapRedBlue();
+            }
+        });
+        std::remove(path.c_str());
+    }
+}
+
+// -------------------- JSON Output --------------------
+static bool writeJson(const std::string& path, const std::vector<BenchmarkResult>& results) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        printf("Error: cannot write %s\n", path.c_str());
+        return false;
+    }
+    fprintf(file, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"ops_per_iteration\": %lld, \"iterations\": %lld, "
+            "\"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f, \"max_ns_per_op\": %.3f}%s\n",
+            r.name.c_str(), r.opsPerIteration, r.iterations, r.nsPerOp, r.minNsPerOp, r.maxNsPerOp,
+            i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    bool ok = !ferror(file);
+    if (fclose(file) != 0) ok = false;
+    if (!ok) printf("Error: failed writing %s\n", path.c_str());
+    return ok;
+}
+
+// Reads the (name, ns_per_op) pairs of a file written by writeJson. Only
+// this program's own output is expected, so each entry is found by its keys
+// instead of with a general JSON parser.
+static bool readJson(const std::string& path, std::vector<std::pair<std::string, double>>& entries) {
+    std::ifstream file(path);
+    if (!file) {
+        printf("Error: cannot open baseline %s\n", path.c_str());
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    const std::string nameKey = "\"name\": \"", timeKey = "\"ns_per_op\": ";
+    for (size_t pos = text.find(nameKey); pos != std::string::npos; pos = text.find(nameKey, pos)) {
+        pos += nameKey.size();
+        size_t nameEnd = text.find('"', pos);
+        size_t timePos = text.find(timeKey, pos);
+        if (nameEnd == std::string::npos || timePos == std::string::npos) break;
+        entries.push_back({ text.substr(pos, nameEnd - pos), atof(text.c_str() + timePos + timeKey.size()) });
+    }
+    if (entries.empty()) {
+        printf("Error: no results in baseline %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// -------------------- Baseline Comparison --------------------
+// Returns the number of benchmarks more than 'threshold' percent slower
+static int compareWithBaseline(const std::vector<BenchmarkResult>& results,
+    const std::vector<std::pair<std::string, double>>& baseline, double threshold) {
+    printf("\n%-36s %14s %14s %9s\n", "benchmark", "baseline ns", "current ns", "change");
+    int regressions = 0;
+    for (const auto& result : results) {
+        auto it = std::find_if(baseline.begin(), baseline.end(),
+            [&result](const std::pair<std::string, double>& entry) { return entry.first == result.name; });
+        if (it == baseline.end() || it->second <= 0.0) {
+            printf("%-36s %14s %14.2f %9s\n", result.name.c_str(), "-", result.nsPerOp, "new");
+            continue;
+        }
+        double change = (result.nsPerOp / it->second - 1.0) * 100.0;
+        const char* verdict = "";
+        if (change > threshold) {
+            verdict = "  REGRESSION";
+            ++regressions;
+        }
+        else if (change < -threshold) verdict = "  faster";
+        printf("%-36s %14.2f %14.2f %+8.1f%%%s\n", result.name.c_str(), it->second, result.nsPerOp, change, verdict);
+    }
+    printf("%d regression(s) above %.1f%%\n", regressions, threshold);
+    return regressions;
+}
+
+// -------------------- Main Program --------------------
+int main(int argc, char** argv) {
+    BenchmarkOptions opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Load the baseline first so a bad path fails before the long run
+    std::vector<std::pair<std::string, double>> baseline;
+    if (opt.baseline && !readJson(opt.baseline, baseline)) return 1;
+
+    BenchmarkRunner runner(opt);
+    printf("%-36s %14s %14s %14s %12s\n", "benchmark", "ns/op", "min ns/op", "max ns/op", "iterations");
+    benchCarUpdate(runner);
+    benchStandings(runner);
+    benchCollisions(runner);
+    benchTrack(runner, opt.scratch);
+    benchImage(runner, opt.scratch);
+
+    if (opt.json && !writeJson(opt.json, runner.results)) return 1;
+    if (opt.baseline && compareWithBaseline(runner.results, baseline, opt.threshold) > 0) return 1;
+    return 0;
+}
@@ -0,0 +1,23 @@
+# Runs the headless runner twice and fails unless both runs print the same
+# position checksum. Used by ctest for the determinism checks:
+#   cmake -DHEADLESS=<exe> "-DFIRST=<args>" "-DSECOND=<args>" -P CompareChecksums.cmake
+# FIRST and SECOND are semicolon-separated argument lists.
+
+foreach(run FIRST SECOND)
+    string(REPLACE ";" " " ${run}_TEXT "${${run}}")
+    execute_process(COMMAND ${HEADLESS} ${${run}}
+        RESULT_VARIABLE status OUTPUT_VARIABLE output ERROR_VARIABLE output)
+    if(NOT status EQUAL 0)
+        message(FATAL_ERROR "headless ${${run}_TEXT} failed (${status}):\n${output}")
+    endif()
+    if(NOT output MATCHES "checksum: +([-0-9.]+)")
+        message(FATAL_ERROR "headless ${${run}_TEXT} printed no checksum:\n${output}")
+    endif()
+    set(${run}_CHECKSUM ${CMAKE_MATCH_1})
+endforeach()
+
+message(STATUS "headless ${FIRST_TEXT}: ${FIRST_CHECKSUM}")
+message(STATUS "headless ${SECOND_TEXT}: ${SECOND_CHECKSUM}")
+if(NOT FIRST_CHECKSUM STREQUAL SECOND_CHECKSUM)
+    message(FATAL_ERROR "Checksums differ: ${FIRST_CHECKSUM} vs ${SECOND_CHECKSUM}")
+endif()
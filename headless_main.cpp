@@ -0,0 +1,328 @@
+// headless_main.cpp : batch CLI runner for the GL-free simulation core.
+// Runs N cars for M ticks as fast as the CPU allows and reports throughput.
+//
+// Usage: headless [--cars N] [--ticks M] [--dt SECONDS] [--seed S] [--fleet] [--scan]
+//                 [--double-buffer] [--threads T] [--track FILE] [--scenario FILE]
+//                 [--record FILE] [--checkpoint TICK] [--profile FILE] [--models LIST]
+//                 [--events FILE] [--collisions]
+
+#include "Simulation.h"
+#include "CarFleet.h"
+#include "Scenario.h"
+#include "Replay.h"
+#include "Profiler.h"
+#include "RaceEvents.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// -------------------- Run Options --------------------
+struct HeadlessOptions {
+    int cars = 3;              // Number of cars on the grid
+    long long ticks = 10000;   // Number of simulation steps to run
+    float dt = 0.016f;         // Time step per tick (same as the GLUT loop)
+    unsigned int seed = 1;     // Seed for the car parameter randomisation
+    bool fleet = false;        // Step the structure-of-arrays CarFleet instead of std::vector<Car>
+    bool scan = false;         // Use the legacy all-cars neighbour scan instead of the lane index
+    bool doubleBuffer = false; // Snapshot-read / per-car-write tick (implied by --threads > 1)
+    int threads = 1;           // Thread pool size for double-buffered and fleet ticks
+    const char* track = nullptr;    // Track file (default: built-in ellipse)
+    const char* scenario = nullptr; // Scenario file; replaces --cars, --seed and --track
+    const char* record = nullptr;   // Replay file to record every tick into
+    long long checkpoint = -1;      // Snapshot this tick, then rewind to it and re-run the rest
+    const char* profile = nullptr;  // Chrome trace file; also prints per-phase latencies
+    std::vector<CarModel> models;   // Car models dealt out to the cars in turn (empty = keep)
+    const char* events = nullptr;   // Race event log written by a background thread
+    bool collisions = false;        // Separate overlapping cars after every tick
+};
+
+// -------------------- Usage --------------------
+static void printUsage(const char* exe) {
+    printf("Usage: %s [--cars N] [--ticks M] [--dt SECONDS] [--seed S] [--fleet] [--scan]\n"
+           "       [--double-buffer] [--threads T] [--track FILE] [--scenario FILE]\n"
+           "       [--record FILE] [--checkpoint TICK] [--profile FILE] [--models LIST]\n"
+           "       [--events FILE] [--collisions]\n"
+           "  LIST is a comma-separated list of kinematic, grip, aggressive\n", exe);
+}
+
+// -------------------- Argument Parsing --------------------
+// "grip,aggressive" -> { Grip, Aggressive }; false on an unknown name
+static bool parseModels(const char* list, std::vector<CarModel>& models) {
+    std::string text = list;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        if (comma == std::string::npos) comma = text.size();
+        CarModel model;
+        if (!parseCarModel(text.substr(start, comma - start).c_str(), model)) return false;
+        models.push_back(model);
+        start = comma + 1;
+    }
+    return true;
+}
+
+// Returns false if the command line is invalid
+static bool parseArgs(int argc, char** argv, HeadlessOptions& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(arg, "--cars") && hasValue) opt.cars = atoi(argv[++i]);
+        else if (!strcmp(arg, "--ticks") && hasValue) opt.ticks = atoll(argv[++i]);
+        else if (!strcmp(arg, "--dt") && hasValue) opt.dt = static_cast<float>(atof(argv[++i]));
+        else if (!strcmp(arg, "--seed") && hasValue) opt.seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        else if (!strcmp(arg, "--fleet")) opt.fleet = true;
+        else if (!strcmp(arg, "--scan")) opt.scan = true;
+        else if (!strcmp(arg, "--double-buffer")) opt.doubleBuffer = true;
+        else if (!strcmp(arg, "--threads") && hasValue) opt.threads = atoi(argv[++i]);
+        else if (!strcmp(arg, "--track") && hasValue) opt.track = argv[++i];
+        else if (!strcmp(arg, "--scenario") && hasValue) opt.scenario = argv[++i];
+        else if (!strcmp(arg, "--record") && hasValue) opt.record = argv[++i];
+        else if (!strcmp(arg, "--checkpoint") && hasValue) opt.checkpoint = atoll(argv[++i]);
+        else if (!strcmp(arg, "--profile") && hasValue) opt.profile = argv[++i];
+        else if (!strcmp(arg, "--events") && hasValue) opt.events = argv[++i];
+        else if (!strcmp(arg, "--collisions")) opt.collisions = true;
+        else if (!strcmp(arg, "--models") && hasValue) {
+            if (!parseModels(argv[++i], opt.models)) return false;
+        }
+        else return false;
+    }
+    if (opt.threads > 1) opt.doubleBuffer = true;
+    return opt.cars > 0 && opt.ticks > 0 && opt.dt > 0.0f && opt.threads > 0 && !(opt.scan && opt.doubleBuffer) &&
+        opt.checkpoint < opt.ticks;
+}
+
+// -------------------- Replay Check --------------------
+// Reads a finished recording back: decodes it tick by tick to the end, then
+// seeks to the last tick through the keyframe index, and compares both with
+// the cars' final state. Positions must agree to one quantisation step
+// (1/1024 unit), lanes, laps and the finished flag exactly. Returns the
+// largest position error, or a negative value if the replay does not match.
+static double checkReplay(const char* path, const std::vector<Car>& cars, long long ticks) {
+    ReplayReader reader;
+    if (!reader.open(path) || reader.tickCount() != ticks + 1) return -1.0;
+    while (reader.next()) {}
+    double maxError = 0.0;
+    for (int pass = 0; pass < 2; ++pass) {
+        if (reader.tick() != reader.tickCount() - 1 || reader.states().size() != cars.size()) return -1.0;
+        for (size_t i = 0; i < cars.size(); ++i) {
+            const ReplayCarState& state = reader.states()[i];
+            double error = std::max(std::fabs(state.position.x - cars[i].position.x),
+                std::fabs(state.position.y - cars[i].position.y));
+            if (!(error <= 1.0 / 1024.0) || state.lane != cars[i].laneIndex || state.lap != cars[i].lap ||
+                state.finished != cars[i].finished)
+                return -1.0;
+            maxError = std::max(maxError, error);
+        }
+        // Second pass: the same tick reached by seeking from its keyframe
+        if (pass == 0 && (!reader.seek(0) || !reader.seek(reader.tickCount() - 1))) return -1.0;
+    }
+    return maxError;
+}
+
+// -------------------- Main Program --------------------
+int main(int argc, char** argv) {
+    HeadlessOptions opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Build the race exactly as the GLUT app does, but with a fixed seed
+    auto loadStart = std::chrono::steady_clock::now();
+    Simulation sim;
+    std::string trackPath = opt.track ? opt.track : "";
+    if (opt.scenario) {
+        Scenario scenario;
+        if (!scenario.load(opt.scenario) || !scenario.apply(sim)) return 1;
+        opt.cars = static_cast<int>(sim.cars.size());
+        trackPath = scenario.trackPath;
+    }
+    else {
+        if (opt.track && !sim.loadTrack(opt.track)) return 1;
+        srand(opt.seed);
+        sim.setupGrid(opt.cars);
+    }
+    double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+    sim.useLaneIndex = !opt.scan;
+    if (!opt.models.empty()) {
+        for (size_t i = 0; i < sim.cars.size(); ++i)
+            sim.cars[i].model = opt.models[i % opt.models.size()];
+    }
+
+    ThreadPool pool(opt.threads);
+    if (opt.doubleBuffer) {
+        sim.tickMode = Simulation::TickMode::DoubleBuffered;
+        sim.pool = &pool;
+    }
+
+    // Copy the grid into the SoA fleet when requested (outside the timed region)
+    CarFleet fleet(&sim.track);
+    if (opt.fleet) fleet.assign(sim.cars);
+    sim.collisions = fleet.collisions = opt.collisions;
+    const CarCollisions& collider = opt.fleet ? fleet.collider : sim.collider;
+    long long contactCount = 0, candidateCount = 0;
+
+    // Race events go to a log file on the stream's consumer thread, which also
+    // counts them by type; the simulation only pushes into its ring
+    EventStream events;
+    long long eventCounts[3] = {};
+    if (opt.events) {
+        if (!events.openLog(opt.events)) return 1;
+        events.subscribe([&eventCounts](const RaceEvent& event) { ++eventCounts[static_cast<int>(event.type)]; });
+        events.start();
+        sim.events = &events;
+        sim.updateStandings(); // Baseline: the grid itself is not an event
+    }
+
+    // Record the starting grid as tick 0 of the replay
+    ReplayWriter recorder;
+    if (opt.record) {
+        if (!recorder.open(opt.record, sim, trackPath, opt.dt)) return 1;
+        recorder.record(sim.cars);
+    }
+
+    // Snapshot taken at tick opt.checkpoint (the fleet is copied back first)
+    SimSnapshot checkpoint;
+    double snapshotSeconds = 0.0;
+    auto takeCheckpoint = [&](long long t) {
+        if (t != opt.checkpoint) return;
+        if (opt.fleet) fleet.storeTo(sim.cars);
+        auto snapStart = std::chrono::steady_clock::now();
+        sim.snapshot(checkpoint);
+        snapshotSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - snapStart).count();
+    };
+
+    // Run the requested number of ticks back to back (recording is timed too)
+    if (opt.profile) g_profiler.setEnabled(true);
+    auto start = std::chrono::steady_clock::now();
+    if (opt.fleet) {
+        for (long long t = 0; t < opt.ticks; ++t) {
+            takeCheckpoint(t);
+            fleet.step(opt.dt, &pool);
+            ++sim.stepCount; // Kept in step with the fleet (checkpoints, event ticks)
+            if (opt.record || opt.events) fleet.storeTo(sim.cars);
+            if (opt.events) sim.updateStandings();
+            if (opt.record) recorder.record(sim.cars);
+            contactCount += collider.contacts().size();
+            candidateCount += collider.candidatePairs();
+        }
+    }
+    else {
+        for (long long t = 0; t < opt.ticks; ++t) {
+            takeCheckpoint(t);
+            sim.step(opt.dt);
+            if (opt.record) recorder.record(sim.cars);
+            contactCount += collider.contacts().size();
+            candidateCount += collider.candidatePairs();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    g_profiler.setEnabled(false);
+    if (opt.record && !recorder.close()) return 1;
+    sim.events = nullptr; // The rewound re-run below is not logged
+    if (opt.events && !events.stop()) {
+        printf("Error: failed writing event log %s\n", opt.events);
+        return 1;
+    }
+
+    if (opt.fleet) {
+        fleet.storeTo(sim.cars);
+        sim.updateStandings();
+    }
+    double replayError = opt.record ? checkReplay(opt.record, sim.cars, opt.ticks) : 0.0;
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double ticksPerSec = seconds > 0.0 ? opt.ticks / seconds : 0.0;
+    double carUpdatesPerSec = ticksPerSec * opt.cars;
+
+    // Position checksum lets runs on different machines be compared for equality
+    auto positionChecksum = [&sim]() {
+        double sum = 0.0;
+        for (const auto& car : sim.cars)
+            sum += car.position.x + car.position.y;
+        return sum;
+    };
+    double checksum = positionChecksum();
+    int maxLap = 0;
+    for (const auto& car : sim.cars)
+        if (car.lap > maxLap) maxLap = car.lap;
+    int leader = sim.standings.leader();
+
+    // Rewind to the checkpoint and run the rest again: a deterministic
+    // simulation must arrive at the same checksum
+    double restoreSeconds = 0.0, branchChecksum = 0.0;
+    if (opt.checkpoint >= 0) {
+        auto restoreStart = std::chrono::steady_clock::now();
+        if (!sim.restore(checkpoint)) return 1;
+        restoreSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - restoreStart).count();
+        if (opt.fleet) {
+            fleet.assign(sim.cars);
+            for (long long t = opt.checkpoint; t < opt.ticks; ++t)
+                fleet.step(opt.dt, &pool);
+            fleet.storeTo(sim.cars);
+        }
+        else {
+            for (long long t = opt.checkpoint; t < opt.ticks; ++t)
+                sim.step(opt.dt);
+        }
+        branchChecksum = positionChecksum();
+    }
+
+    printf("storage:           %s\n", opt.fleet ? "CarFleet (SoA)" : "std::vector<Car>");
+    printf("neighbour search:  %s\n", (opt.scan && !opt.fleet) ? "full scan" : "lane index");
+    printf("tick mode:         %s\n", (opt.doubleBuffer || opt.fleet) ? "double-buffered" : "sequential");
+    printf("threads:           %d\n", pool.threadCount());
+    printf("lanes:             %d\n", sim.track.laneCount());
+    printf("cars:              %d\n", opt.cars);
+    if (!opt.models.empty()) {
+        int perModel[kCarModelCount] = {};
+        for (const auto& car : sim.cars) ++perModel[static_cast<int>(car.model)];
+        printf("models:           ");
+        for (int m = 0; m < kCarModelCount; ++m)
+            if (perModel[m]) printf(" %s %d", carModelName(static_cast<CarModel>(m)), perModel[m]);
+        printf("\n");
+    }
+    printf("load time:         %.2f ms\n", loadSeconds * 1000.0);
+    printf("ticks:             %lld\n", opt.ticks);
+    printf("sim time:          %.2f s\n", opt.ticks * static_cast<double>(opt.dt));
+    printf("wall time:         %.3f s\n", seconds);
+    printf("ticks/sec:         %.1f\n", ticksPerSec);
+    printf("car-updates/sec:   %.1f\n", carUpdatesPerSec);
+    printf("leader lap:        %d\n", maxLap);
+    if (leader >= 0)
+        printf("leader:            %s\n", sim.carNames[leader].c_str());
+    printf("checksum:          %.6f\n", checksum);
+    if (opt.collisions) {
+        printf("collisions:        %.2f contacts, %.2f broadphase pairs per tick\n",
+            static_cast<double>(contactCount) / opt.ticks, static_cast<double>(candidateCount) / opt.ticks);
+    }
+    if (opt.record) {
+        printf("replay:            %s, %lld bytes (%.2f bytes per car-tick)\n", opt.record, recorder.bytes(),
+            static_cast<double>(recorder.bytes()) / (static_cast<double>(recorder.ticks()) * opt.cars));
+        if (replayError >= 0.0) printf("replay check:      final tick matches (max position error %.6f)\n", replayError);
+        else printf("replay check:      MISMATCH\n");
+    }
+    if (opt.events) {
+        printf("events:            %lld laps, %lld lane changes, %lld overtakes (%lld dropped) -> %s\n",
+            eventCounts[0], eventCounts[1], eventCounts[2], events.dropped(), opt.events);
+    }
+    if (opt.checkpoint >= 0) {
+        printf("checkpoint:        tick %lld, %zu bytes, snapshot %.1f us, restore %.1f us\n", opt.checkpoint,
+            checkpoint.bytes.size(), snapshotSeconds * 1e6, restoreSeconds * 1e6);
+        printf("rewound checksum:  %.6f (%s)\n", branchChecksum, branchChecksum == checksum ? "match" : "MISMATCH");
+    }
+    if (opt.profile) {
+        printf("\n");
+        g_profiler.printReport();
+        if (!g_profiler.writeTrace(opt.profile)) return 1;
+        printf("trace:             %s\n", opt.profile);
+    }
+    // A replay or rewind that does not reproduce the race fails the run (ctest relies on this)
+    if (replayError < 0.0 || (opt.checkpoint >= 0 && branchChecksum != checksum)) return 1;
+    return 0;
+}
@@ -1,14 +1,29 @@
 #include "stdafx.h"
-#include "Car.h"
-#include "Track.h"
+#include "Simulation.h"
+#include "Scenario.h"
+#include "FixedStepClock.h"
+#include "Replay.h"
+#include "Profiler.h"
+#include "CarRenderer.h"
+#include "TrackRenderer.h"
 #include "Textures.h"
+#include "TextRenderer.h"
+#include "SpatialGrid.h"
+#include "RaceEvents.h"
+#include "Spectator.h"
+#include "OffscreenContext.h"
+#include "FrameWriter.h"
 #include <vector>
 #include <GL/glut.h>
 #include <string>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
 
 // Camera globals
 static float camX = 0.0f;        // Camera X position
@@ -17,43 +32,110 @@ static float camZoom = 1.0f;     // Camera zoom level
 static int cameraMode = 0;       // Camera mode: 0 = overview, 1 = follow leading car, 2 = follow specific car
 static int followCarIndex = 0;   // Index of car to follow in mode 2
 
-// Track and cars
-Track track;                     // Track object
-std::vector<Car> cars;           // Vector storing all cars
-std::vector<std::string> carNames = { "BMW", "Mercedes", "Ford" }; // Names of the cars
+// Simulation state (track, lanes and cars) and the views used by the rendering code
+Simulation sim;                                 // GL-free race state
+Track& track = sim.track;                       // Track object
+std::vector<Car>& cars = sim.cars;              // Vector storing all cars
+std::vector<std::string>& carNames = sim.carNames; // Names of the cars
+TrackRenderer trackRenderer(sim.track);         // Draws the track and owns its textures
+TextRenderer textRenderer;                      // Batches the labels and sidebar text
+
+// HUD strings, rebuilt only when the lap or standings they show change
+static std::vector<std::string> carLabels;      // "Lap: N" per car
+static std::vector<int> carLabelLaps;           // Lap each label was built for
+static std::vector<std::string> sidebarLines;   // "P. Name Lap: N" per position
+static std::vector<std::pair<int, int>> sidebarKeys; // (car index, lap) each line was built for
+
+// Simulation timing: fixed physics steps driven by the real clock
+static FixedStepClock simClock(240.0f);          // Physics rate (see --hz)
+static std::chrono::steady_clock::time_point lastFrameTime; // Time of the previous update()
+
+// Time warp: 'f' cycles the clock's time scale. While warping, each update
+// steps until kWarpStepBudget of real time is spent and drops the steps left
+// over, updates follow each other without the 16 ms wait, and frames are
+// drawn at most every kWarpRedrawSeconds, so input stays responsive at any speed
+static const float kWarpScales[] = { 1.0f, 10.0f, 100.0f, 1e6f }; // The last is "max": only the budget limits it
+static const int kWarpLevels = sizeof(kWarpScales) / sizeof(kWarpScales[0]);
+static const double kWarpStepBudget = 0.012;     // Real seconds of stepping per warped update
+static const double kWarpRedrawSeconds = 0.05;   // Least real time between warped frames
+static int warpLevel = 0;                        // Index into kWarpScales
+static double warpAchieved = 1.0;                // Simulated seconds per real second, smoothed
+static std::chrono::steady_clock::time_point lastRedrawTime; // Last frame requested while warping
+
+// Replays: --record writes every physics step, --replay plays a recording
+// back through the same drawing code instead of stepping the cars
+static ReplayWriter recorder;                    // Open while recording
+static ReplayReader replay;                      // Recording being played back
+static bool replaying = false;                   // Cars follow 'replay' instead of sim.step()
+static bool replayPaused = false;                // Playback halted (space)
+static SimSnapshot checkpoint;                   // Race state saved with 'k', restored with 'r'
+
+// Spectators: --spectate publishes every tick shown here to viewer processes,
+// --watch makes this process such a viewer of another one's race
+static SpectatorServer spectators;               // Open while publishing
+static SpectatorClient spectator;                // Stream being watched
+static bool watching = false;                    // Cars follow 'spectator' instead of sim.step()
+static bool watchEnded = false;                  // The watched stream closed (reported once)
+
+// Profiling: 'p' starts and stops the phase timers; stopping prints the
+// latency table and writes the trace (--profile starts them at launch)
+static std::string profilePath = "profile.json"; // Chrome trace written when profiling stops
+
+// Race events: lead changes are announced on the console by the stream's
+// consumer thread, and --events also logs every event to a file
+static EventStream raceEvents;
+
+// Asset loading: textures are decoded on g_textures' loader threads while the
+// window opens, and uploaded a few per frame; cars and track use their plain
+// colours until then
+static std::chrono::steady_clock::time_point launchTime; // Start of main()
+static bool firstFrameShown = false;
+static const double kUploadBudget = 0.004;       // Seconds of texture upload per frame
+
+// Offscreen rendering: --render draws a fixed number of frames at a fixed
+// frame rate into an EGL pbuffer instead of a window and writes them as
+// images (see renderOffscreen)
+static const int kWindowWidth = 900;
+static const int kWindowHeight = 700;
 
 // -------------------- Utility Functions --------------------
 
-// Display text in world coordinates at (x, y)
-void displayText(float x, float y, const std::string& text) {
-    glRasterPos2f(x, y);
-    for (char c : text)
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, c);
+// Returns the cached "Lap: N" label of car i
+const std::string& carLabel(int i) {
+    if (carLabels.size() != cars.size()) {
+        carLabels.assign(cars.size(), std::string());
+        carLabelLaps.assign(cars.size(), -1);
+    }
+    if (carLabelLaps[i] != cars[i].lap) {
+        carLabelLaps[i] = cars[i].lap;
+        carLabels[i] = "Lap: " + std::to_string(cars[i].lap);
+    }
+    return carLabels[i];
 }
 
-// Display text in screen coordinates at (x, y) regardless of camera transform
-void displayScreenText(float x, float y, const std::string& text) {
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    gluOrtho2D(0, 900, 0, 700); // Screen space coordinates
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
-
-    glColor3f(1.0f, 1.0f, 1.0f); // White text
-    glRasterPos2f(x, y);
-    for (char c : text)
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, c);
+// Returns the cached sidebar line for position 'rank' (0-based) held by car idx
+const std::string& sidebarLine(int rank, int idx) {
+    if (sidebarLines.size() != cars.size()) {
+        sidebarLines.assign(cars.size(), std::string());
+        sidebarKeys.assign(cars.size(), { -1, -1 });
+    }
+    std::pair<int, int> key(idx, cars[idx].lap);
+    if (sidebarKeys[rank] != key) {
+        sidebarKeys[rank] = key;
+        sidebarLines[rank] = std::to_string(rank + 1) + ". " + carNames[idx] + " Lap: " + std::to_string(cars[idx].lap);
+    }
+    return sidebarLines[rank];
+}
 
-    glPopMatrix();
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
+// Name of the current time warp: "10x", ..., "max"
+static std::string warpName() {
+    if (warpLevel == kWarpLevels - 1) return "max";
+    return std::to_string(static_cast<int>(kWarpScales[warpLevel])) + "x";
 }
 
 // Draw sidebar showing the positions of all cars
 void drawSidebar() {
+    PROFILE_SCOPE("drawSidebar");
     glDisable(GL_TEXTURE_2D);  // Disable textures for sidebar
     glColor3f(0.1f, 0.1f, 0.1f); // Dark background
     glBegin(GL_QUADS);
@@ -64,29 +146,44 @@ void drawSidebar() {
     glEnd();
     glEnable(GL_TEXTURE_2D); // Re-enable textures
 
-    // Calculate progress for each car
-    std::vector<std::pair<int, float>> carProgress; // <carIndex, distanceAlongTrack>
-    for (int i = 0; i < cars.size(); ++i) {
-        float progress = cars[i].lap * track.lane1.size() + cars[i].targetIndex;
-        carProgress.push_back({ i, progress });
-    }
+    // Queue the top of the standings; lines below the window are skipped
+    int visible = std::min(sim.standings.size(), 670 / 30 + 1);
+    for (int i = 0; i < visible; ++i)
+        textRenderer.addScreenText(710, 670 - i * 30, sidebarLine(i, sim.standings.carAt(i)), 1.0f, 1.0f, 1.0f);
+}
 
-    // Sort cars in descending order of progress
-    std::sort(carProgress.begin(), carProgress.end(), [](auto& a, auto& b) { return a.second > b.second; });
+// -------------------- Asset Loading --------------------
 
-    // Display car positions and lap number
-    for (int i = 0; i < carProgress.size(); ++i) {
-        int idx = carProgress[i].first;
-        Car& c = cars[idx];
-        std::string info = std::to_string(i + 1) + ". " + carNames[idx] + " Lap: " + std::to_string(c.lap);
-        displayScreenText(710, 670 - i * 30, info);
-    }
+// Milliseconds since main() started
+static double msSinceLaunch() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - launchTime).count();
+}
+
+// Uploads textures decoded since the last frame and hands them to the renderers
+static void pollAssets() {
+    if (!g_textures.loading() || !g_textures.pumpUploads(kUploadBudget)) return;
+    g_carTex = g_textures.get("car.bmp");
+    g_wheelTex = g_textures.get("wheel.bmp");
+    trackRenderer.refreshTextures();
+    if (g_textures.loading()) return;
+
+    if (!g_carTex) printf("Warning: car.bmp not loaded (falling back to color)\n");
+    if (!g_wheelTex) printf("Warning: wheel.bmp not loaded (falling back to simple wheels)\n");
+    g_textures.printStats();
+    printf("Assets ready after %.1f ms\n", msSinceLaunch());
 }
 
 // -------------------- Rendering --------------------
 
-// Main display callback
-void display() {
+// -------------------- View Culling --------------------
+// Cars narrower than kDetailPixels on screen are drawn as batched bodies
+// without wheels or labels; labels reach about kLabelPixels from their car
+static const float kDetailPixels = 12.0f;
+static const float kLabelPixels = 80.0f;
+
+// Draws the current frame into the back buffer (window or offscreen)
+static void drawFrame() {
+    textRenderer.prepare(); // Builds the glyph atlas on the first frame, before the clear
     glClear(GL_COLOR_BUFFER_BIT);
     glLoadIdentity();
 
@@ -96,62 +193,169 @@ void display() {
     glTranslatef(-camX, -camY, 0.0f);
 
     // Draw the track
-    track.draw();
-
-    // Draw all cars and their lap info
-    for (auto& car : cars) {
-        car.draw();
-        displayText(car.position.x - 0.3f, car.position.y + 1.0f, "Lap: " + std::to_string(car.lap));
+    trackRenderer.draw();
+
+    // Draw the visible cars and queue their lap info (black, like the wheels
+    // before), blended between the last two physics steps
+    textRenderer.captureTransform();
+    float pixelsPerUnit = 1.0f;
+    ViewRect view = visibleWorldRect(&pixelsPerUnit);
+    float alpha = simClock.alpha();
+    if (!cars.empty()) {
+        // One pass over the current positions; cars far from the view are not
+        // interpolated. The margin covers the last step's movement and the labels.
+        ViewRect reach = view.expanded(2.0f + kLabelPixels / pixelsPerUnit);
+        bool detailed = 2.0f * cars[0].size * pixelsPerUnit >= kDetailPixels;
+        if (!detailed) glBegin(GL_QUADS);
+        for (int i = 0; i < static_cast<int>(cars.size()); ++i) {
+            const Vector2& at = cars[i].position;
+            if (at.x < reach.minX || at.x > reach.maxX || at.y < reach.minY || at.y > reach.maxY) continue;
+            CarPose pose = sim.renderPose(i, alpha);
+            float size = cars[i].size * 1.5f; // Covers the rotated body and wheels
+            ViewRect bounds = { pose.position.x - size, pose.position.y - size, pose.position.x + size, pose.position.y + size };
+            if (detailed) {
+                if (bounds.overlaps(view)) drawCar(cars[i], pose);
+                if (bounds.expanded(kLabelPixels / pixelsPerUnit).overlaps(view))
+                    textRenderer.addWorldText(pose.position.x - 0.3f, pose.position.y + 1.0f, carLabel(i), 0.0f, 0.0f, 0.0f);
+            }
+            else if (bounds.overlaps(view)) {
+                emitCarBody(cars[i], pose);
+            }
+        }
+        if (!detailed) glEnd();
     }
 
     glPopMatrix();
 
-    // Draw sidebar overlay
+    // Draw sidebar overlay, then all queued text in one batch
     drawSidebar();
+    if (warpLevel > 0) {
+        char warpText[64];
+        snprintf(warpText, sizeof(warpText), "Time warp %s (running at %.0fx)", warpName().c_str(), warpAchieved);
+        textRenderer.addScreenText(10, 670, warpText, 0.0f, 0.0f, 0.0f);
+    }
+    textRenderer.flush();
+}
 
+// Main display callback
+void display() {
+    PROFILE_SCOPE("display");
+    pollAssets();
+    drawFrame();
     glutSwapBuffers();
+    if (!firstFrameShown) {
+        firstFrameShown = true;
+        printf("First frame after %.1f ms (%s)\n", msSinceLaunch(),
+            g_textures.loading() ? "textures still loading" : "textures ready");
+    }
 }
 
 // -------------------- Update Loop --------------------
 
-// Timer/update callback (~60 FPS)
-void update(int value) {
-    float dt = 0.016f; // Time step ~16ms
+// Advances the race (or replay, or watched stream) by 'frameSeconds': runs
+// as many fixed physics steps as that calls for and moves the camera once.
+// Returns the number of steps run.
+static int advanceFrame(float frameSeconds) {
+    // Warped frames stop stepping once the budget is spent
+    bool budgeted = warpLevel > 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(kWarpStepBudget);
+    bool outOfTime = false;
+    auto overBudget = [&]() {
+        outOfTime = budgeted && std::chrono::steady_clock::now() >= deadline;
+        return outOfTime;
+    };
+
+    // Update all cars; poses before the last step are kept for interpolation
+    int steps = simClock.advance(frameSeconds);
+    int run = 0;
+    if (replaying) {
+        // Playback: decode recorded ticks instead of simulating them
+        for (int s = 0; s < steps && !replayPaused && !overBudget(); ++s, ++run) {
+            if (s == steps - 1) sim.savePoses();
+            if (!replay.next()) {
+                replayPaused = true; // End of the recording
+                sim.savePoses();
+                break;
+            }
+            replay.apply(cars);
+            spectators.publish(cars);
+        }
+        sim.updateStandings();
+    }
+    else if (watching) {
+        // Live view: decode received ticks at the stream's tick rate; a backlog
+        // of more than a quarter second is skipped to stay close to the race
+        int backlog = spectator.queuedTicks() - static_cast<int>(0.25f / simClock.stepSeconds);
+        for (; backlog > 0 && spectator.next(); --backlog) {}
+        for (int s = 0; s < steps; ++s, ++run) {
+            if (s == steps - 1) sim.savePoses();
+            if (!spectator.next()) break; // Nothing received yet
+            spectator.apply(cars);
+            spectators.publish(cars);
+        }
+        if (!spectator.connected() && !watchEnded) {
+            watchEnded = true;
+            printf("Spectator stream ended (%lld ticks missed)\n", spectator.ticksMissed());
+        }
+        sim.updateStandings();
+    }
+    else {
+        for (int s = 0; s < steps && !overBudget(); ++s, ++run) {
+            if (s == steps - 1) sim.savePoses();
+            sim.step(simClock.stepSeconds);
+            if (recorder.isOpen()) recorder.record(cars);
+            spectators.publish(cars);
+        }
+    }
+    if (outOfTime) {
+        // The rest of the warped frame is dropped; the cars are drawn where
+        // they are, not blended with a pose from before this frame
+        simClock.discard(steps - run);
+        sim.savePoses();
+    }
 
-    // Update all cars
-    for (auto& car : cars)
-        car.update(dt, &cars);
+    // Camera easing: 5% per 16 ms frame, scaled to the real frame time
+    float follow = 1.0f - std::pow(0.95f, frameSeconds / 0.016f);
+    float alpha = simClock.alpha();
 
     // Camera movement logic
     if (cameraMode == 1) {
         // Follow the leading car
-        float leadX = 0.0f, leadY = 0.0f;
-        float farthestDist = -1.0f;
-        for (auto& car : cars) {
-            float distAlongTrack = car.lap * track.lane1.size() + car.targetIndex;
-            if (distAlongTrack > farthestDist) {
-                farthestDist = distAlongTrack;
-                leadX = car.position.x;
-                leadY = car.position.y;
-            }
-        }
-        camX += (leadX - camX) * 0.05f;
-        camY += (leadY - camY) * 0.05f;
+        int leader = sim.standings.leader();
+        Vector2 p = leader >= 0 ? sim.renderPose(leader, alpha).position : Vector2(0.0f, 0.0f);
+        camX += (p.x - camX) * follow;
+        camY += (p.y - camY) * follow;
     }
     else if (cameraMode == 2 && followCarIndex >= 0 && followCarIndex < cars.size()) {
         // Follow a specific car
-        Car& c = cars[followCarIndex];
-        camX += (c.position.x - camX) * 0.05f;
-        camY += (c.position.y - camY) * 0.05f;
+        Vector2 p = sim.renderPose(followCarIndex, alpha).position;
+        camX += (p.x - camX) * follow;
+        camY += (p.y - camY) * follow;
     }
     else {
         // Overview mode: center camera on track
-        camX += (0.0f - camX) * 0.05f;
-        camY += (0.0f - camY) * 0.05f;
+        camX += (0.0f - camX) * follow;
+        camY += (0.0f - camY) * follow;
     }
+    return run;
+}
 
-    glutPostRedisplay();
-    glutTimerFunc(16, update, 0);
+// Timer/update callback (~60 FPS), driven by the real time since the previous
+// frame; while warping it runs back to back and redraws only now and then
+void update(int value) {
+    PROFILE_SCOPE("update");
+    auto now = std::chrono::steady_clock::now();
+    float frameSeconds = std::chrono::duration<float>(now - lastFrameTime).count();
+    lastFrameTime = now;
+    int steps = advanceFrame(frameSeconds);
+    if (frameSeconds > 0.0f)
+        warpAchieved += (steps * simClock.stepSeconds / frameSeconds - warpAchieved) * 0.1;
+
+    if (warpLevel == 0 || std::chrono::duration<double>(now - lastRedrawTime).count() >= kWarpRedrawSeconds) {
+        lastRedrawTime = now;
+        glutPostRedisplay();
+    }
+    glutTimerFunc(warpLevel > 0 ? 1 : 16, update, 0);
 }
 
 // -------------------- Window/Projection --------------------
@@ -164,8 +368,8 @@ void reshape(int w, int h) {
 
     // Set orthographic view based on track size
     float viewMargin = 2.0f;
-    float maxX = 12.0f;
-    float maxY = 7.0f;
+    float maxX = track.radiusX + 2.0f;
+    float maxY = track.radiusY + 2.0f;
     gluOrtho2D(-maxX - viewMargin, maxX + viewMargin, -maxY - viewMargin, maxY + viewMargin);
 
     glMatrixMode(GL_MODELVIEW);
@@ -173,6 +377,13 @@ void reshape(int w, int h) {
 
 // -------------------- Input Handling --------------------
 
+// Stops the phase timers, prints their latency table and writes the trace
+static void stopProfiling() {
+    g_profiler.setEnabled(false);
+    g_profiler.printReport();
+    if (g_profiler.writeTrace(profilePath)) printf("Trace written to %s\n", profilePath.c_str());
+}
+
 // Keyboard input callback
 void keyboard(unsigned char key, int x, int y) {
     if (key == '+') camZoom *= 1.1f;    // Zoom in
@@ -187,7 +398,48 @@ void keyboard(unsigned char key, int x, int y) {
             printf("Now following: %s\n", carNames[followCarIndex].c_str());
         }
     }
-    else if (key == 27) exit(0); // ESC key exits
+    else if (!watching && (key == 'f' || key == 'F')) {
+        // Cycle the time warp (a watched race runs at the publisher's pace)
+        warpLevel = (warpLevel + 1) % kWarpLevels;
+        simClock.timeScale = kWarpScales[warpLevel];
+        warpAchieved = 1.0;
+        printf("Time warp: %s\n", warpName().c_str());
+    }
+    else if (replaying && key == ' ') replayPaused = !replayPaused; // Pause/resume playback
+    else if (replaying && (key == '[' || key == ']')) {
+        // Seek 5 seconds back/forward; poses are reset so nothing is blended across the jump
+        int delta = static_cast<int>(5.0f / replay.tickSeconds) * (key == '[' ? -1 : 1);
+        if (replay.seek(replay.tick() + delta)) {
+            replay.apply(cars);
+            sim.savePoses();
+            sim.rebaseEvents();
+            sim.updateStandings();
+        }
+    }
+    else if (!replaying && !watching && (key == 'k' || key == 'K')) {
+        // Save a checkpoint of the race
+        sim.snapshot(checkpoint);
+        printf("Checkpoint saved at step %lld\n", sim.stepCount);
+    }
+    else if (!replaying && !watching && (key == 'r' || key == 'R') && !checkpoint.bytes.empty()) {
+        // Rewind to the checkpoint; the race continues from there
+        if (sim.restore(checkpoint)) printf("Rewound to step %lld\n", sim.stepCount);
+    }
+    else if (key == 'p' || key == 'P') {
+        // Toggle profiling; stopping reports and exports what was recorded
+        if (!g_profiler.enabled()) {
+            g_profiler.reset();
+            g_profiler.setEnabled(true);
+            printf("Profiling started\n");
+        }
+        else stopProfiling();
+    }
+    else if (key == 27) {
+        // ESC key exits (finishing a running profile and the event log first)
+        if (g_profiler.enabled()) stopProfiling();
+        raceEvents.stop();
+        exit(0);
+    }
     glutPostRedisplay();
 }
 
@@ -201,43 +453,174 @@ void specialKeys(int key, int x, int y) {
     glutPostRedisplay();
 }
 
+// -------------------- Offscreen Rendering --------------------
+
+// Renders 'frameCount' frames, each 1/fps seconds of race, into the current
+// offscreen context and hands them to a FrameWriter thread, which encodes and
+// writes one frame while the next ones are drawn. Reports the frame rate;
+// returns false if a frame could not be written.
+static bool renderOffscreen(const std::string& directory, int frameCount, float fps, FrameWriter::Format format) {
+    // Frames show the textures from the first one on
+    while (g_textures.loading()) {
+        pollAssets();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    FrameWriter writer;
+    writer.open(directory, kWindowWidth, kWindowHeight, format);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1); // Rows of 900 RGB pixels are not a multiple of 4 bytes
+
+    double drawSeconds = 0.0;
+    int frame = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (; frame < frameCount && !writer.failed(); ++frame) {
+        if (frame > 0) advanceFrame(1.0f / fps);
+        unsigned char* pixels = writer.acquire();
+        auto drawStart = std::chrono::steady_clock::now();
+        {
+            PROFILE_SCOPE("render");
+            drawFrame();
+            glReadPixels(0, 0, kWindowWidth, kWindowHeight, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+        }
+        drawSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - drawStart).count();
+        writer.submit();
+    }
+    bool ok = writer.close();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const FrameWriter::Stats& stats = writer.stats();
+    double perFrame = frame > 0 ? 1000.0 / frame : 0.0;
+    printf("Rendered %d frames (%dx%d) in %.2f s: %.1f frames/sec\n",
+        frame, kWindowWidth, kWindowHeight, seconds, seconds > 0.0 ? frame / seconds : 0.0);
+    printf("  draw + read back %.2f ms/frame, writer %.2f ms/frame (%.1f MB written), waited %.2f ms/frame for the writer\n",
+        drawSeconds * perFrame, stats.writeSeconds * perFrame, stats.bytes / (1024.0 * 1024.0), stats.waitSeconds * perFrame);
+    if (ok) printf("Frames written to %s\n", directory.c_str());
+    return ok;
+}
+
 // -------------------- Main Program --------------------
 int main(int argc, char** argv) {
+    launchTime = std::chrono::steady_clock::now();
     srand(static_cast<unsigned int>(time(nullptr))); // Seed RNG
 
-    glutInit(&argc, argv);
-    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
-    glutInitWindowSize(900, 700);
-    glutCreateWindow("Car Racing Track Simulation");
+    // Start decoding textures first; they need no GL context until upload
+    g_textures.request("car.bmp");
+    g_textures.request("wheel.bmp");
+    trackRenderer.requestTextures();
+
+    const char* trackPath = nullptr;
+    const char* scenarioPath = nullptr;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    const char* eventsPath = nullptr;
+    const char* spectatePath = nullptr;
+    const char* watchPath = nullptr;
+    const char* renderPath = nullptr;
+    int renderFrames = 240;
+    float renderFps = 60.0f;
+    FrameWriter::Format renderFormat = FrameWriter::Format::PPM;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--track")) trackPath = argv[i + 1];
+        else if (!strcmp(argv[i], "--scenario")) scenarioPath = argv[i + 1];
+        else if (!strcmp(argv[i], "--hz") && atof(argv[i + 1]) > 0.0) simClock = FixedStepClock(static_cast<float>(atof(argv[i + 1])));
+        else if (!strcmp(argv[i], "--record")) recordPath = argv[i + 1];
+        else if (!strcmp(argv[i], "--replay")) replayPath = argv[i + 1];
+        else if (!strcmp(argv[i], "--events")) eventsPath = argv[i + 1];
+        else if (!strcmp(argv[i], "--spectate")) spectatePath = argv[i + 1];
+        else if (!strcmp(argv[i], "--watch")) watchPath = argv[i + 1];
+        else if (!strcmp(argv[i], "--render")) renderPath = argv[i + 1];
+        else if (!strcmp(argv[i], "--frames")) renderFrames = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--fps") && atof(argv[i + 1]) > 0.0) renderFps = static_cast<float>(atof(argv[i + 1]));
+        else if (!strcmp(argv[i], "--image")) renderFormat = strcmp(argv[i + 1], "png") ? FrameWriter::Format::PPM : FrameWriter::Format::PNG;
+        else if (!strcmp(argv[i], "--camera")) cameraMode = std::abs(atoi(argv[i + 1])) % 3;
+        else if (!strcmp(argv[i], "--seed")) srand(static_cast<unsigned int>(strtoul(argv[i + 1], nullptr, 10)));
+        else if (!strcmp(argv[i], "--profile")) {
+            profilePath = argv[i + 1];
+            g_profiler.setEnabled(true);
+        }
+    }
+
+    // Open the window, or for --render an offscreen context of the same size
+    // (no display needed; GLUT is not started, so the HUD text is left out)
+    OffscreenContext offscreen;
+    if (renderPath) {
+        if (!offscreen.create(kWindowWidth, kWindowHeight)) return 1;
+        textRenderer.enabled = false;
+    }
+    else {
+        glutInit(&argc, argv);
+        glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
+        glutInitWindowSize(kWindowWidth, kWindowHeight);
+        glutCreateWindow("Car Racing Track Simulation");
+    }
 
     // Enable alpha blending & textures
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glEnable(GL_TEXTURE_2D);
 
-    // Load textures
-    g_carTex = loadBMP_custom("car.bmp");
-    g_wheelTex = loadBMP_custom("wheel.bmp");
-
-    if (!g_carTex) printf("Warning: car.bmp not loaded (falling back to color)\n");
-    if (!g_wheelTex) printf("Warning: wheel.bmp not loaded (falling back to simple wheels)\n");
+    // Initialize cars with lane, color, speed, and acceleration:
+    // from a replay, a scenario file, on a track file, or the default three-car field
+    Scenario scenario;
+    if (watchPath) {
+        // Follow another process's race at its tick rate
+        if (!spectator.connect(watchPath) || !spectator.setup(sim)) return 1;
+        simClock = FixedStepClock(1.0f / spectator.tickSeconds);
+        watching = true;
+        printf("Watching %s: %d cars at %.0f Hz\n", watchPath, static_cast<int>(cars.size()), 1.0f / spectator.tickSeconds);
+    }
+    else if (replayPath) {
+        // Play back at the recorded tick rate
+        if (!replay.open(replayPath) || !replay.setup(sim)) return 1;
+        simClock = FixedStepClock(1.0f / replay.tickSeconds);
+        replaying = true;
+        printf("Replay: %d ticks (%.1f s). Space = pause, [ / ] = seek 5 s\n",
+            replay.tickCount(), replay.tickCount() * replay.tickSeconds);
+    }
+    else if (scenarioPath) {
+        if (!scenario.load(scenarioPath) || !scenario.apply(sim)) return 1;
+    }
+    else {
+        if (trackPath && !sim.loadTrack(trackPath)) return 1;
+        sim.setupGrid(3);
+    }
 
-    // Build lane data
-    std::vector<std::vector<Vector2>> allLanes = { track.lane1, track.lane2, track.lane3 };
-
-    // Initialize cars with lane, color, speed, and acceleration
-    for (int i = 0; i < 3; ++i) {
-        // Assign distinct RGB color for each car
-        float r = (i == 0) ? 1.0f : 0.0f; // BMW red
-        float g = (i == 1) ? 1.0f : 0.0f; // Mercedes green
-        float b = (i == 2) ? 1.0f : 0.0f; // Ford blue
-        std::vector<Vector2>* lane = &allLanes[i];
-
-        Car car(lane->at(0), r, g, b, lane, &allLanes, i);
-        car.maxSpeed = 4.8f + static_cast<float>(rand()) / RAND_MAX * 0.5f;
-        car.speed = 1.0f + static_cast<float>(rand()) / RAND_MAX;
-        car.accelerationFactor = 1.8f + static_cast<float>(rand()) / RAND_MAX * 0.5f;
-        cars.push_back(car);
+    // Record the starting grid as tick 0; later ticks are added by update()
+    std::string raceTrack = watching ? spectator.trackPath : replaying ? replay.trackPath :
+        scenarioPath ? scenario.trackPath : (trackPath ? trackPath : "");
+    if (recordPath && !replaying && !watching) {
+        if (!recorder.open(recordPath, sim, raceTrack, simClock.stepSeconds)) return 1;
+        recorder.record(cars);
+    }
+    // Spectators get the starting grid (or first shown tick) the same way
+    if (spectatePath) {
+        if (!spectators.open(spectatePath, sim, raceTrack, simClock.stepSeconds)) return 1;
+        spectators.publish(cars);
+        printf("Publishing to spectators on %s\n", spectatePath);
+    }
+    // The subscriber runs on the consumer thread, so it gets its own copy of the names
+    if (eventsPath && !raceEvents.openLog(eventsPath)) return 1;
+    std::vector<std::string> names = carNames;
+    raceEvents.subscribe([names](const RaceEvent& event) {
+        if (event.type == RaceEventType::Overtake && event.b == 0)
+            printf("%s takes the lead from %s\n", names[event.car].c_str(), names[event.a].c_str());
+    });
+    raceEvents.start();
+    sim.events = &raceEvents;
+
+    // Live races push overlapping cars apart (replays and watched races are not simulated)
+    sim.collisions = true;
+
+    sim.savePoses();
+    sim.updateStandings();
+    lastFrameTime = std::chrono::steady_clock::now();
+
+    if (renderPath) {
+        reshape(kWindowWidth, kWindowHeight);
+        bool ok = renderOffscreen(renderPath, renderFrames, renderFps, renderFormat);
+        if (g_profiler.enabled()) stopProfiling();
+        raceEvents.stop();
+        return ok ? 0 : 1;
     }
 
     // Register callbacks
@@ -0,0 +1,117 @@
+// montecarlo_main.cpp : Monte Carlo race batch runner.
+// Runs many independent races of the default three-car field across a
+// work-stealing thread pool and prints win probability and lap time
+// distributions per car configuration.
+//
+// Usage: montecarlo [--races N] [--threads T] [--laps L] [--seed S] [--race K] [--events FILE]
+//   --race K re-runs only race K of the batch and prints its details.
+//   --events FILE logs the laps, lane changes and overtakes of every race.
+
+#include "RaceBatch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+// -------------------- Run Options --------------------
+struct MonteCarloOptions {
+    long long races = 10000;   // Number of races in the batch
+    int threads = 0;           // Pool size (0 = hardware concurrency)
+    int laps = 3;              // Laps per race
+    unsigned long long seed = 1; // Batch seed
+    long long replayRace = -1; // Single race to reproduce (-1 = run the batch)
+    const char* events = nullptr; // Race event log
+};
+
+// -------------------- Usage --------------------
+static void printUsage(const char* exe) {
+    printf("Usage: %s [--races N] [--threads T] [--laps L] [--seed S] [--race K] [--events FILE]\n", exe);
+}
+
+// -------------------- Argument Parsing --------------------
+static bool parseArgs(int argc, char** argv, MonteCarloOptions& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(arg, "--races") && hasValue) opt.races = atoll(argv[++i]);
+        else if (!strcmp(arg, "--threads") && hasValue) opt.threads = atoi(argv[++i]);
+        else if (!strcmp(arg, "--laps") && hasValue) opt.laps = atoi(argv[++i]);
+        else if (!strcmp(arg, "--seed") && hasValue) opt.seed = strtoull(argv[++i], nullptr, 10);
+        else if (!strcmp(arg, "--race") && hasValue) opt.replayRace = atoll(argv[++i]);
+        else if (!strcmp(arg, "--events") && hasValue) opt.events = argv[++i];
+        else return false;
+    }
+    return opt.races > 0 && opt.threads >= 0 && opt.laps > 0;
+}
+
+// -------------------- Single Race Report --------------------
+static void printRace(const RaceBatch& batch, long long index) {
+    RaceResult race = batch.runRace(index);
+    printf("race %lld (seed %llu)\n", index, static_cast<unsigned long long>(batch.seed));
+    for (size_t c = 0; c < batch.configs.size(); ++c) {
+        printf("  %-10s %s", batch.configs[c].name.c_str(), static_cast<int>(c) == race.winner ? "WIN " : "    ");
+        if (race.finishTime[c] >= 0.0f) printf(" finish %7.3f s  laps:", race.finishTime[c]);
+        else printf(" did not finish   laps:");
+        for (float lap : race.lapTimes[c]) printf(" %.3f", lap);
+        printf("\n");
+    }
+}
+
+// -------------------- Main Program --------------------
+int main(int argc, char** argv) {
+    MonteCarloOptions opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    RaceBatch batch;
+    batch.laps = opt.laps;
+    batch.seed = opt.seed;
+
+    EventStream events;
+    if (opt.events) {
+        if (!events.openLog(opt.events)) return 1;
+        events.start();
+        batch.events = &events;
+    }
+
+    if (opt.replayRace >= 0) {
+        printRace(batch, opt.replayRace);
+        return events.stop() ? 0 : 1;
+    }
+
+    int threads = opt.threads > 0 ? opt.threads : static_cast<int>(std::thread::hardware_concurrency());
+    ThreadPool pool(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ConfigStats> stats = batch.run(opt.races, pool);
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    printf("races: %lld  laps: %d  threads: %d  seed: %llu\n",
+        opt.races, opt.laps, pool.threadCount(), static_cast<unsigned long long>(opt.seed));
+    printf("wall time: %.3f s  races/sec: %.1f\n", seconds, seconds > 0.0 ? opt.races / seconds : 0.0);
+    if (opt.events) {
+        if (!events.stop()) {
+            printf("Error: failed writing event log %s\n", opt.events);
+            return 1;
+        }
+        printf("events: %lld (%lld dropped) -> %s\n", events.delivered(), events.dropped(), opt.events);
+    }
+    printf("\n");
+
+    printf("%-10s %8s %9s %9s %9s %9s %9s %9s %10s\n",
+        "car", "win %", "lap mean", "lap sd", "lap p10", "lap p50", "lap p90", "lap min", "race mean");
+    for (size_t c = 0; c < stats.size(); ++c) {
+        const ConfigStats& s = stats[c];
+        printf("%-10s %8.2f %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f %10.3f\n",
+            batch.configs[c].name.c_str(),
+            100.0 * s.wins / opt.races,
+            s.lapTime.mean, s.lapTime.stddev(),
+            s.lapHistogram.quantile(0.10), s.lapHistogram.quantile(0.50), s.lapHistogram.quantile(0.90),
+            s.lapTime.min, s.raceTime.mean);
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+// render_check_main.cpp : compares TrackRenderer's cached layer with immediate mode.
+// Renders each track offscreen at a range of zoom levels and camera positions,
+// once through the retained path (layer tiles or display lists) and once with
+// retained = false, and compares the frames. The layer is rasterised on its
+// own pixel grid, so where the camera is not pixel-aligned its edges may land
+// one pixel off; a pixel only counts as wrong when no pixel of the immediate
+// frame within one pixel of it has its colour. One-pixel lane lines drawn at
+// another subpixel offset can also lose a pixel here and there, so a frame
+// fails when more than kMaxWrongPixels are wrong (a missing tile or a band of
+// grass over the road is thousands). Exits with status 1 if any frame fails,
+// and 77 (skipped) when no offscreen GL context is available.
+//
+// Usage: render_check [TRACK_FILE...]   (the built-in track is always checked)
+
+#include "stdafx.h"
+#include "Track.h"
+#include "TrackRenderer.h"
+#include "OffscreenContext.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static const int kWidth = 900;
+static const int kHeight = 700;
+static const int kMaxWrongPixels = 64;   // Per frame, for line rasterisation differences
+
+// Draws the track as the GLUT application's display() does and reads the frame back
+static void renderFrame(TrackRenderer& renderer, float zoom, Vector2 camera, std::vector<unsigned char>& pixels) {
+    glClear(GL_COLOR_BUFFER_BIT);
+    glLoadIdentity();
+    glPushMatrix();
+    glScalef(zoom, zoom, 1.0f);
+    glTranslatef(-camera.x, -camera.y, 0.0f);
+    renderer.draw();
+    glPopMatrix();
+    glReadPixels(0, 0, kWidth, kHeight, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+}
+
+// Pixels of 'cached' whose colour appears nowhere in the 3x3 neighbourhood
+// of the same pixel in 'immediate'. The outermost pixels are left out: an edge
+// just outside the immediate frame may be shifted into them.
+static int countWrongPixels(const std::vector<unsigned char>& cached, const std::vector<unsigned char>& immediate) {
+    int wrong = 0;
+    for (int y = 1; y < kHeight - 1; ++y) {
+        for (int x = 1; x < kWidth - 1; ++x) {
+            const unsigned char* c = &cached[(static_cast<size_t>(y) * kWidth + x) * 3];
+            bool found = false;
+            for (int dy = -1; dy <= 1 && !found; ++dy) {
+                for (int dx = -1; dx <= 1 && !found; ++dx) {
+                    int nx = x + dx, ny = y + dy;
+                    const unsigned char* i = &immediate[(static_cast<size_t>(ny) * kWidth + nx) * 3];
+                    found = c[0] == i[0] && c[1] == i[1] && c[2] == i[2];
+                }
+            }
+            wrong += !found;
+        }
+    }
+    return wrong;
+}
+
+// Checks one track; returns the number of frames that fail
+static int checkTrack(const Track& track, const char* name) {
+    // Projection as in the application's reshape()
+    glViewport(0, 0, kWidth, kHeight);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    float maxX = track.radiusX + 4.0f, maxY = track.radiusY + 4.0f;
+    gluOrtho2D(-maxX, maxX, -maxY, maxY);
+    glMatrixMode(GL_MODELVIEW);
+
+    TrackRenderer renderer(track);
+    std::vector<unsigned char> cached(kWidth * kHeight * 3), immediate(cached.size());
+
+    // Cameras: the centre, and points along the middle lane (as when following a car)
+    std::vector<Vector2> cameras(1, Vector2(0.0f, 0.0f));
+    float length = track.laneLength(0);
+    for (int k = 0; k < 4; ++k) {
+        float s = length * k / 4.0f;
+        cameras.push_back(track.pointAt(0, s, track.segmentAt(0, s)));
+    }
+
+    int frames = 0, failures = 0;
+    float zoom = 1.0f;
+    for (int press = 0; press <= 30; ++press, zoom *= 1.1f) {  // '+' zooms by 10%
+        for (const Vector2& camera : cameras) {
+            renderer.retained = true;
+            renderFrame(renderer, zoom, camera, cached);
+            renderer.retained = false;
+            renderFrame(renderer, zoom, camera, immediate);
+            ++frames;
+
+            int differing = countWrongPixels(cached, immediate);
+            if (differing > kMaxWrongPixels) {
+                printf("Error: %s at zoom %.2f, camera (%.1f, %.1f): %d pixels wrong\n",
+                    name, zoom, camera.x, camera.y, differing);
+                ++failures;
+            }
+        }
+    }
+    printf("%s: %d frames compared, %d failed\n", name, frames, failures);
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    OffscreenContext context;
+    if (!context.create(kWidth, kHeight)) return 77;
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_TEXTURE_2D);
+
+    int failures = checkTrack(Track(), "built-in track");
+    for (int i = 1; i < argc; ++i) {
+        Track track;
+        if (!track.load(argv[i])) return 1;
+        failures += checkTrack(track, argv[i]);
+    }
+    return failures ? 1 : 0;
+}